@@ -1,10 +1,14 @@
 // ============================================================================
 // ARKANOID GAME - TEAM PROJECT (Windows Console Version)
 // ============================================================================
-// Compile: gcc arkanoid.c -o arkanoid.exe -lgdi32
+// Compile: gcc arkanoid.c -o arkanoid.exe -lgdi32 -lwinmm
+//          (arkanoid_core.h must sit next to this file)
 // Run: arkanoid.exe
 // ============================================================================
 
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600     // CreateWaitableTimerExA
+#endif
 #include <windows.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,37 +19,45 @@
 // ============================================================================
 // CONSTANTS AND CONFIGURATIONS
 // ============================================================================
+// Geometry and tuning for the shared core; speeds are per second.
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
-#define FPS 60
-#define FRAME_DELAY (1000 / FPS)
+#define FPS 60              // frame cap when the display rate is unknown
+#define SIM_TICK_HZ 120     // fixed simulation step, independent of frame rate
+#define TIMER_SPIN_US 1000  // busy-wait this last stretch instead of sleeping it
 
 // Paddle settings
 #define PADDLE_WIDTH 100
 #define PADDLE_HEIGHT 20
-#define PADDLE_SPEED 12
-#define PADDLE_Y (WINDOW_HEIGHT - 80)
+#define PADDLE_SPEED 720.0f
+#define PADDLE_Y_OFFSET 80
 
 // Ball settings
 #define BALL_SIZE 15
-#define BALL_SPEED 6
+#define BALL_SPEED_INITIAL 360.0f
 
-// Brick settings
+// Brick settings: a 55x25 grid from (15, 50), bricks 50x20 inside each cell
 #define BRICK_ROWS 4
-#define BRICK_COLS 14
-#define BRICK_WIDTH 50
-#define BRICK_HEIGHT 20
+#define BRICK_COLUMNS 14
+#define BRICK_WIDTH 55
+#define BRICK_HEIGHT 25
 #define BRICK_PADDING 5
-#define BRICK_OFFSET_X 15
+#define BRICK_OFFSET_X 13
 #define BRICK_OFFSET_Y 50
+#define BRICK_ROW_PITCH 25
+#define BRICK_SCORE(row) ((BRICK_ROWS - (row)) * 10)
+#define BRICK_COLOR(row, col, level) ((void)(level), (row))
 
 // Game settings
-#define MAX_LIVES 3
+#define STARTING_LIVES 3
 #define MAX_LEVELS 3
 
+#define ARK_CORE_IMPLEMENTATION
+#include "arkanoid_core.h"
+
 // Global variables for Windows
 HWND hwnd;
-HDC hdc;
+HDC window_dc;      // class DC (CS_OWNDC), held for the window's lifetime
 bool keys[256] = {false};
 bool running = true;
 
@@ -54,245 +66,240 @@ bool running = true;
 // Handles: Ball movement, paddle control, collision detection, physics
 // ============================================================================
 
-// Ball structure
-typedef struct {
-    float x, y;
-    float dx, dy;
-    int radius;
-    bool active;
-} Ball;
+// The engine is shared with the SDL build and lives in arkanoid_core.h.
+// This file is a backend over it: GDI rendering, keyboard input and the
+// score file, wired up through win_backend below.
 
-// Paddle structure
-typedef struct {
-    int x, y;
-    int width, height;
-} Paddle;
+Game game;
+
+// ============================================================================
+// COMPONENT 2: GRAPHICS & RENDERING (Member 3 & 4)
+// Handles: Drawing all visual elements using Windows GDI
+// ============================================================================
 
-// Brick structure
+// Back buffer: a 32-bit top-down DIB section selected into a memory DC.
+// Shapes are written straight into its pixels and text goes through GDI on
+// the same DC; present_frame() blits it to the window once per frame. If
+// the DIB can't be created, a compatible bitmap is drawn with the cached
+// brushes below instead.
 typedef struct {
-    int x, y;
+    HDC dc;
+    HBITMAP bitmap, old_bitmap;
+    uint32_t *pixels;       // 0x00RRGGBB rows, NULL on the GDI fallback
     int width, height;
-    bool active;
-    int color_type;
-} Brick;
-
-// Game state structure
+    bool gdi_pending;       // GDI drew since the last GdiFlush
+} BackBuffer;
+
+BackBuffer back_buffer;
+
+// Brick colors, indexed by the brick's color type; the last entry is the
+// fallback for any other type.
+#define BRICK_PALETTE_SIZE 5
+static const COLORREF brick_palette[BRICK_PALETTE_SIZE] = {
+    RGB(0, 255, 0),         // Green
+    RGB(255, 0, 255),       // Magenta
+    RGB(255, 255, 0),       // Yellow
+    RGB(255, 0, 0),         // Red
+    RGB(255, 255, 255),
+};
+
+// Brushes are created once and kept: the brick palette up front, any other
+// color on first use. Only the GDI fallback path needs them.
+#define BRUSH_CACHE_SIZE 16
 typedef struct {
-    int score;
-    int lives;
-    int level;
-    bool paused;
-    bool game_over;
-    bool victory;
-} GameState;
-
-// Initialize ball
-void init_ball(Ball *ball) {
-    ball->x = WINDOW_WIDTH / 2;
-    ball->y = WINDOW_HEIGHT / 2;
-    ball->radius = BALL_SIZE / 2;
-    float angle = ((rand() % 90) - 45) * 3.14159 / 180.0;
-    ball->dx = BALL_SPEED * sin(angle);
-    ball->dy = BALL_SPEED * cos(angle);
-    ball->active = true;
-}
-
-// Initialize paddle
-void init_paddle(Paddle *paddle) {
-    paddle->x = (WINDOW_WIDTH - PADDLE_WIDTH) / 2;
-    paddle->y = PADDLE_Y;
-    paddle->width = PADDLE_WIDTH;
-    paddle->height = PADDLE_HEIGHT;
-}
-
-// Initialize bricks
-void init_bricks(Brick bricks[][BRICK_COLS]) {
-    for (int row = 0; row < BRICK_ROWS; row++) {
-        for (int col = 0; col < BRICK_COLS; col++) {
-            bricks[row][col].x = BRICK_OFFSET_X + col * (BRICK_WIDTH + BRICK_PADDING);
-            bricks[row][col].y = BRICK_OFFSET_Y + row * (BRICK_HEIGHT + BRICK_PADDING);
-            bricks[row][col].width = BRICK_WIDTH;
-            bricks[row][col].height = BRICK_HEIGHT;
-            bricks[row][col].active = true;
-            bricks[row][col].color_type = row;
-        }
-    }
-}
-
-// Update ball position and physics
-void update_ball(Ball *ball, Paddle *paddle, Brick bricks[][BRICK_COLS], GameState *state) {
-    if (state->paused || state->game_over || state->victory) return;
+    HBRUSH brick[BRICK_PALETTE_SIZE];
+    COLORREF color[BRUSH_CACHE_SIZE];
+    HBRUSH brush[BRUSH_CACHE_SIZE];
+    int count;
+} BrushCache;
 
-    ball->x += ball->dx;
-    ball->y += ball->dy;
+BrushCache brushes;
 
-    // Wall collision
-    if (ball->x - ball->radius <= 0 || ball->x + ball->radius >= WINDOW_WIDTH) {
-        ball->dx = -ball->dx;
-    }
+static inline uint32_t pixel_from_color(COLORREF c) {
+    return ((uint32_t)GetRValue(c) << 16) | ((uint32_t)GetGValue(c) << 8) | GetBValue(c);
+}
 
-    // Ceiling collision
-    if (ball->y - ball->radius <= 0) {
-        ball->dy = -ball->dy;
-    }
+int brick_palette_index(int color_type) {
+    return color_type >= 0 && color_type < BRICK_PALETTE_SIZE - 1 ? color_type : BRICK_PALETTE_SIZE - 1;
+}
 
-    // Floor collision (lose life)
-    if (ball->y - ball->radius >= WINDOW_HEIGHT) {
-        state->lives--;
-        if (state->lives <= 0) {
-            state->game_over = true;
-        } else {
-            init_ball(ball);
-        }
-        return;
+HBRUSH cached_brush(COLORREF color) {
+    for (int i = 0; i < brushes.count; i++) {
+        if (brushes.color[i] == color) return brushes.brush[i];
     }
-
-    // Paddle collision
-    if (ball->y + ball->radius >= paddle->y && 
-        ball->y - ball->radius <= paddle->y + paddle->height &&
-        ball->x >= paddle->x && ball->x <= paddle->x + paddle->width) {
-        
-        float paddle_center = paddle->x + paddle->width / 2.0;
-        float hit_pos = (ball->x - paddle_center) / (paddle->width / 2.0);
-        float bounce_angle = hit_pos * 60 * 3.14159 / 180.0;
-        
-        float speed = sqrt(ball->dx * ball->dx + ball->dy * ball->dy);
-        ball->dx = speed * sin(bounce_angle);
-        ball->dy = -fabs(speed * cos(bounce_angle));
-        ball->y = paddle->y - ball->radius;
+    if (brushes.count == BRUSH_CACHE_SIZE) {
+        // full: the DC's own brush, recolored per call
+        SetDCBrushColor(back_buffer.dc, color);
+        return GetStockObject(DC_BRUSH);
     }
+    brushes.color[brushes.count] = color;
+    return brushes.brush[brushes.count++] = CreateSolidBrush(color);
+}
 
-    // Brick collision
-    for (int row = 0; row < BRICK_ROWS; row++) {
-        for (int col = 0; col < BRICK_COLS; col++) {
-            if (!bricks[row][col].active) continue;
-
-            Brick *brick = &bricks[row][col];
-            
-            if (ball->x + ball->radius >= brick->x && 
-                ball->x - ball->radius <= brick->x + brick->width &&
-                ball->y + ball->radius >= brick->y && 
-                ball->y - ball->radius <= brick->y + brick->height) {
-                
-                brick->active = false;
-                state->score += (BRICK_ROWS - row) * 10;
-                
-                float brick_center_x = brick->x + brick->width / 2.0;
-                float brick_center_y = brick->y + brick->height / 2.0;
-                float dx_collision = ball->x - brick_center_x;
-                float dy_collision = ball->y - brick_center_y;
-                
-                if (fabs(dx_collision / brick->width) > fabs(dy_collision / brick->height)) {
-                    ball->dx = -ball->dx;
-                } else {
-                    ball->dy = -ball->dy;
-                }
-            }
-        }
+bool back_buffer_init(HWND window) {
+    BackBuffer *bb = &back_buffer;
+    HDC screen = GetDC(window);
+    bb->width = WINDOW_WIDTH;
+    bb->height = WINDOW_HEIGHT;
+    bb->dc = CreateCompatibleDC(screen);
+    
+    BITMAPINFO bmi = {0};
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = bb->width;
+    bmi.bmiHeader.biHeight = -bb->height;       // negative: top-down rows
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void *bits = NULL;
+    bb->bitmap = CreateDIBSection(screen, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    bb->pixels = bb->bitmap ? (uint32_t *)bits : NULL;
+    if (!bb->bitmap) bb->bitmap = CreateCompatibleBitmap(screen, bb->width, bb->height);
+    ReleaseDC(window, screen);
+    if (!bb->dc || !bb->bitmap) return false;
+    
+    bb->old_bitmap = SelectObject(bb->dc, bb->bitmap);
+    SetBkMode(bb->dc, TRANSPARENT);
+    for (int i = 0; i < BRICK_PALETTE_SIZE; i++) {
+        brushes.brick[i] = CreateSolidBrush(brick_palette[i]);
     }
+    return true;
+}
 
-    // Check victory
-    bool all_destroyed = true;
-    for (int row = 0; row < BRICK_ROWS; row++) {
-        for (int col = 0; col < BRICK_COLS; col++) {
-            if (bricks[row][col].active) {
-                all_destroyed = false;
-                break;
-            }
-        }
-        if (!all_destroyed) break;
+void back_buffer_free(void) {
+    BackBuffer *bb = &back_buffer;
+    if (bb->dc) {
+        if (bb->old_bitmap) SelectObject(bb->dc, bb->old_bitmap);
+        DeleteDC(bb->dc);
     }
-    
-    if (all_destroyed) {
-        state->level++;
-        if (state->level > MAX_LEVELS) {
-            state->victory = true;
-        } else {
-            init_bricks(bricks);
-            init_ball(ball);
-        }
+    if (bb->bitmap) DeleteObject(bb->bitmap);
+    for (int i = 0; i < BRICK_PALETTE_SIZE; i++) {
+        if (brushes.brick[i]) DeleteObject(brushes.brick[i]);
     }
+    for (int i = 0; i < brushes.count; i++) DeleteObject(brushes.brush[i]);
+    memset(bb, 0, sizeof(*bb));
+    memset(&brushes, 0, sizeof(brushes));
 }
 
-// Move paddle
-void move_paddle_left(Paddle *paddle) {
-    paddle->x -= PADDLE_SPEED;
-    if (paddle->x < 0) paddle->x = 0;
+// Direct pixel writes must not overtake GDI calls still batched for the DIB
+static inline uint32_t *back_buffer_pixels(void) {
+    if (back_buffer.gdi_pending) {
+        GdiFlush();
+        back_buffer.gdi_pending = false;
+    }
+    return back_buffer.pixels;
 }
 
-void move_paddle_right(Paddle *paddle) {
-    paddle->x += PADDLE_SPEED;
-    if (paddle->x + paddle->width > WINDOW_WIDTH) {
-        paddle->x = WINDOW_WIDTH - paddle->width;
+void clear_frame(void) {
+    BackBuffer *bb = &back_buffer;
+    uint32_t *px = back_buffer_pixels();
+    if (px) {
+        memset(px, 0, (size_t)bb->width * bb->height * sizeof(uint32_t));
+    } else {
+        RECT rect = { 0, 0, bb->width, bb->height };
+        FillRect(bb->dc, &rect, cached_brush(RGB(0, 0, 0)));
     }
 }
 
-// ============================================================================
-// COMPONENT 2: GRAPHICS & RENDERING (Member 3 & 4)
-// Handles: Drawing all visual elements using Windows GDI
-// ============================================================================
+// Solid fill clipped to the back buffer; brush is used on the GDI fallback
+void fill_rect(int x, int y, int w, int h, uint32_t pixel, HBRUSH brush) {
+    BackBuffer *bb = &back_buffer;
+    uint32_t *px = back_buffer_pixels();
+    if (!px) {
+        RECT rect = { x, y, x + w, y + h };
+        FillRect(bb->dc, &rect, brush);
+        return;
+    }
+    int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int x1 = x + w > bb->width ? bb->width : x + w;
+    int y1 = y + h > bb->height ? bb->height : y + h;
+    for (int row = y0; row < y1; row++) {
+        uint32_t *p = px + (size_t)row * bb->width;
+        for (int col = x0; col < x1; col++) p[col] = pixel;
+    }
+}
 
 // Draw filled rectangle
 void draw_rect(HDC hdc, int x, int y, int w, int h, COLORREF color) {
-    HBRUSH brush = CreateSolidBrush(color);
-    HBRUSH oldBrush = SelectObject(hdc, brush);
-    Rectangle(hdc, x, y, x + w, y + h);
-    SelectObject(hdc, oldBrush);
-    DeleteObject(brush);
+    (void)hdc;   // drawing goes to the back buffer
+    fill_rect(x, y, w, h, pixel_from_color(color), back_buffer.pixels ? NULL : cached_brush(color));
 }
 
-// Draw filled circle
+// Draw filled circle, one horizontal span per row
 void draw_circle(HDC hdc, int cx, int cy, int radius, COLORREF color) {
-    HBRUSH brush = CreateSolidBrush(color);
-    HBRUSH oldBrush = SelectObject(hdc, brush);
-    HPEN pen = CreatePen(PS_SOLID, 1, color);
-    HPEN oldPen = SelectObject(hdc, pen);
-    
-    Ellipse(hdc, cx - radius, cy - radius, cx + radius, cy + radius);
-    
-    SelectObject(hdc, oldPen);
-    SelectObject(hdc, oldBrush);
-    DeleteObject(pen);
-    DeleteObject(brush);
+    (void)hdc;
+    uint32_t pixel = pixel_from_color(color);
+    HBRUSH brush = back_buffer.pixels ? NULL : cached_brush(color);
+    for (int dy = -radius; dy < radius; dy++) {
+        float fy = dy + 0.5f;
+        int half = (int)(sqrtf((float)(radius * radius) - fy * fy) + 0.5f);
+        if (half > 0) fill_rect(cx - half, cy + dy, 2 * half, 1, pixel, brush);
+    }
+}
+
+// Blit the finished frame to the window
+void present_frame(HDC window_dc) {
+    GdiFlush();
+    back_buffer.gdi_pending = false;
+    RECT rect;
+    GetClientRect(hwnd, &rect);
+    BitBlt(window_dc, 0, 0, rect.right, rect.bottom, back_buffer.dc, 0, 0, SRCCOPY);
+}
+
+// Position between the previous and the latest sim tick
+static inline float lerp_pos(float from, float to, float alpha) {
+    return from + (to - from) * alpha;
 }
 
 // Render paddle
-void render_paddle(HDC hdc, Paddle *paddle) {
-    draw_rect(hdc, paddle->x, paddle->y, paddle->width, paddle->height, RGB(30, 144, 255));
+void render_paddle(HDC hdc, const Game *g, float alpha) {
+    const RectF *r = &g->paddle.rect;
+    int x = (int)lerp_pos(g->paddle_prev_rect.x, r->x, alpha);
+    draw_rect(hdc, x, (int)r->y, (int)r->w, (int)r->h, RGB(30, 144, 255));
 }
 
-// Render ball
-void render_ball(HDC hdc, Ball *ball) {
-    draw_circle(hdc, (int)ball->x, (int)ball->y, ball->radius, RGB(255, 255, 255));
+// Render balls (multi-ball can put several in play)
+void render_balls(HDC hdc, const Game *g, float alpha) {
+    for (int i = 0; i < g->ball_count; i++) {
+        const RectF *r = &g->balls[i].rect;
+        const RectF *prev = &g->ball_prev_rect[i];
+        float x = lerp_pos(prev->x, r->x, alpha), y = lerp_pos(prev->y, r->y, alpha);
+        draw_circle(hdc, (int)(x + r->w / 2), (int)(y + r->h / 2), BALL_SIZE / 2, RGB(255, 255, 255));
+    }
 }
 
-// Render bricks
-void render_bricks(HDC hdc, Brick bricks[][BRICK_COLS]) {
-    for (int row = 0; row < BRICK_ROWS; row++) {
-        for (int col = 0; col < BRICK_COLS; col++) {
-            if (!bricks[row][col].active) continue;
+// Render bricks: live ones only, found through the alive mask, in the
+// rows that fall inside the window
+void render_bricks(HDC hdc, const Game *g) {
+    (void)hdc;
+    const Board *board = &g->board;
+    RectF view = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
+    int r0, r1, c0, c1;
+    if (!brick_cells_for_rect(board, &view, &r0, &r1, &c0, &c1)) return;
+
+    int end = (r1 + 1) * board->cols;
+    for (int i = board_next_alive(board, r0 * board->cols, end); i < end; i = board_next_alive(board, i + 1, end)) {
+        RectF r = brick_rect(board, i / board->cols, i % board->cols);
+        int type = brick_palette_index(brick_color(board, i));
+        int w = (int)r.w > 0 ? (int)r.w : 1, h = (int)r.h > 0 ? (int)r.h : 1;
+        fill_rect((int)r.x, (int)r.y, w, h, pixel_from_color(brick_palette[type]), brushes.brick[type]);
+    }
+}
 
-            Brick *brick = &bricks[row][col];
-            COLORREF color;
-            
-            switch (brick->color_type) {
-                case 0: color = RGB(0, 255, 0); break;      // Green
-                case 1: color = RGB(255, 0, 255); break;    // Magenta
-                case 2: color = RGB(255, 255, 0); break;    // Yellow
-                case 3: color = RGB(255, 0, 0); break;      // Red
-                default: color = RGB(255, 255, 255); break;
-            }
-            
-            draw_rect(hdc, brick->x, brick->y, brick->width, brick->height, color);
-        }
+// Render falling power-ups
+void render_collectibles(HDC hdc, const Game *g) {
+    for (int i = 0; i < MAX_COLLECTIBLES; i++) {
+        const Collectible *c = &g->collectibles[i];
+        if (!c->alive) continue;
+        COLORREF color = c->type == COLLECT_MULTIBALL ? RGB(90, 220, 255) : RGB(255, 200, 80);
+        draw_rect(hdc, (int)c->rect.x, (int)c->rect.y, (int)c->rect.w, (int)c->rect.h, color);
     }
 }
 
 // Render text
 void render_text(HDC hdc, const char *text, int x, int y, COLORREF color) {
     SetTextColor(hdc, color);
-    SetBkMode(hdc, TRANSPARENT);
     TextOut(hdc, x, y, text, strlen(text));
+    back_buffer.gdi_pending = true;
 }
 
 // ============================================================================
@@ -300,15 +307,15 @@ void render_text(HDC hdc, const char *text, int x, int y, COLORREF color) {
 // Handles: Keyboard input for paddle movement and game control
 // ============================================================================
 
-// Update paddle based on input
-void handle_paddle_input(Paddle *paddle, GameState *state) {
-    if (state->paused || state->game_over || state->victory) return;
-    
+// Update paddle based on input (core poll_input hook; the core moves it)
+void handle_paddle_input(void *user, Game *g) {
+    (void)user;
+    g->paddle.velocity_x = 0.0f;
     if (keys[VK_LEFT] || keys['A']) {
-        move_paddle_left(paddle);
+        g->paddle.velocity_x -= PADDLE_SPEED;
     }
     if (keys[VK_RIGHT] || keys['D']) {
-        move_paddle_right(paddle);
+        g->paddle.velocity_x += PADDLE_SPEED;
     }
 }
 
@@ -317,28 +324,104 @@ void handle_paddle_input(Paddle *paddle, GameState *state) {
 // Handles: Score tracking, lives management, level progression
 // ============================================================================
 
-// Initialize game state
-void init_game_state(GameState *state) {
-    state->score = 0;
-    state->lives = MAX_LIVES;
-    state->level = 1;
-    state->paused = false;
-    state->game_over = false;
-    state->victory = false;
-}
+// Write-behind score persistence. save_score() only records the score and
+// wakes a background thread, so the game loop never touches the disk.
+// Requests that arrive before the thread runs coalesce into one commit.
+// A commit appends the finished games to highscore_history.txt. It then
+// writes the best score alone to a temp file and renames it over
+// highscore.txt, so startup reads one number however long the history is.
+#define HIGHSCORE_FILE "highscore.txt"
+#define HIGHSCORE_TMP "highscore.txt.tmp"
+#define HISTORY_FILE "highscore_history.txt"
+#define PERSIST_MAX_PENDING 64
 
-// Save score to file
-void save_score(int score) {
-    FILE *file = fopen("highscore.txt", "a");
+typedef struct {
+    CRITICAL_SECTION lock;
+    HANDLE wake;
+    HANDLE thread;
+    volatile LONG quit;
+    int best;                           // best score known, committed or not
+    int pending[PERSIST_MAX_PENDING];   // finished-game scores not yet in history
+    int pending_count;
+    bool dirty;
+} ScoreStore;
+
+ScoreStore score_store;
+
+static void commit_scores(const int *scores, int count, int best) {
+    FILE *file = fopen(HISTORY_FILE, "a");
     if (file) {
-        fprintf(file, "%d\n", score);
+        for (int i = 0; i < count; i++) fprintf(file, "%d\n", scores[i]);
         fclose(file);
     }
+    file = fopen(HIGHSCORE_TMP, "w");
+    if (!file) return;
+    bool ok = fprintf(file, "%d\n", best) > 0;
+    if (fclose(file) != 0) ok = false;
+    if (ok) MoveFileExA(HIGHSCORE_TMP, HIGHSCORE_FILE, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+static DWORD WINAPI persist_thread(LPVOID arg) {
+    ScoreStore *st = (ScoreStore *)arg;
+    int scores[PERSIST_MAX_PENDING];
+    for (;;) {
+        WaitForSingleObject(st->wake, INFINITE);
+        EnterCriticalSection(&st->lock);
+        bool dirty = st->dirty;
+        int count = st->pending_count, best = st->best;
+        for (int i = 0; i < count; i++) scores[i] = st->pending[i];
+        st->pending_count = 0;
+        st->dirty = false;
+        LeaveCriticalSection(&st->lock);
+        if (dirty) commit_scores(scores, count, best);
+        if (InterlockedCompareExchange(&st->quit, 0, 0)) break;
+    }
+    return 0;
+}
+
+void persist_start(int best) {
+    InitializeCriticalSection(&score_store.lock);
+    score_store.best = best;
+    score_store.wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (score_store.wake) 
+        score_store.thread = CreateThread(NULL, 0, persist_thread, &score_store, 0, NULL);
+}
+
+// Flushes anything still pending and joins the thread.
+void persist_stop(void) {
+    if (score_store.thread) {
+        InterlockedExchange(&score_store.quit, 1);
+        SetEvent(score_store.wake);
+        WaitForSingleObject(score_store.thread, INFINITE);
+        CloseHandle(score_store.thread);
+    }
+    if (score_store.wake) CloseHandle(score_store.wake);
+    DeleteCriticalSection(&score_store.lock);
+}
+
+// Save score to file (asynchronously)
+void save_score(int score) {
+    ScoreStore *st = &score_store;
+    EnterCriticalSection(&st->lock);
+    if (st->pending_count < PERSIST_MAX_PENDING) st->pending[st->pending_count++] = score;
+    if (score > st->best) st->best = score;
+    st->dirty = true;
+    LeaveCriticalSection(&st->lock);
+    if (st->thread) {
+        SetEvent(st->wake);
+    } else {
+        // no thread: commit inline
+        int count = st->pending_count;
+        st->pending_count = 0;
+        st->dirty = false;
+        commit_scores(st->pending, count, st->best);
+    }
 }
 
-// Load high score
+// Load high score. highscore.txt normally holds one number; a legacy
+// append-only file is scanned once and collapsed by the next commit.
 int load_high_score() {
-    FILE *file = fopen("highscore.txt", "r");
+    FILE *file = fopen(HIGHSCORE_FILE, "r");
     int high_score = 0;
     if (file) {
         int score;
@@ -350,8 +433,14 @@ int load_high_score() {
     return high_score;
 }
 
+// Core game_over hook: the final score goes to persistence once per game
+void save_final_score(void *user, Game *g) {
+    (void)user;
+    save_score(g->game_state.score);
+}
+
 // Render UI
-void render_ui(HDC hdc, GameState *state) {
+void render_ui(HDC hdc, const GameState *state) {
     char buffer[100];
     
     // Score
@@ -383,7 +472,7 @@ void render_pause(HDC hdc) {
 }
 
 // Render game over
-void render_game_over(HDC hdc, GameState *state) {
+void render_game_over(HDC hdc, const GameState *state) {
     draw_rect(hdc, WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 50, 300, 100, RGB(255, 0, 0));
     
     char buffer[100];
@@ -397,7 +486,7 @@ void render_game_over(HDC hdc, GameState *state) {
 }
 
 // Render victory
-void render_victory(HDC hdc, GameState *state) {
+void render_victory(HDC hdc, const GameState *state) {
     draw_rect(hdc, WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 50, 300, 100, RGB(0, 255, 0));
     
     char buffer[100];
@@ -410,6 +499,132 @@ void render_victory(HDC hdc, GameState *state) {
     render_text(hdc, "Press R to restart", WINDOW_WIDTH/2 - 70, WINDOW_HEIGHT/2 + 30, RGB(0, 0, 0));
 }
 
+// Render serve hint while the ball waits on the paddle
+void render_serve_hint(HDC hdc) {
+    render_text(hdc, "Press SPACE to launch", WINDOW_WIDTH/2 - 75, WINDOW_HEIGHT/2 + 40, RGB(200, 200, 200));
+}
+
+// The core stops the run when the last life is lost or the last level cleared
+bool game_finished(const Game *g) {
+    return !g->game_state.is_running;
+}
+
+// Core render hook: one full frame into the back buffer, then one blit.
+// Moving objects are drawn alpha of the way from the previous tick to the
+// latest, so motion stays smooth when frames and ticks don't line up.
+void render_frame(void *user, const Game *g, float alpha) {
+    (void)user;
+    const GameState *state = &g->game_state;
+    HDC hdc = back_buffer.dc;
+    
+    // Clear background
+    clear_frame();
+    
+    // Draw game elements
+    render_bricks(hdc, g);
+    render_collectibles(hdc, g);
+    render_paddle(hdc, g, alpha);
+    render_balls(hdc, g, alpha);
+    render_ui(hdc, state);
+    
+    // Draw overlays
+    if (state->is_paused) render_pause(hdc);
+    else if (game_finished(g) && state->level > MAX_LEVELS) render_victory(hdc, state);
+    else if (game_finished(g)) render_game_over(hdc, state);
+    else if (g->balls[0].is_held) render_serve_hint(hdc);
+    
+    present_frame(window_dc);
+}
+
+// Hooks the core calls back into; levels use the core's built-in layout
+const ArkBackend win_backend = {
+    NULL, NULL, save_final_score, NULL, render_frame, handle_paddle_input
+};
+
+// ============================================================================
+// FRAME TIMING
+// Handles: Frame time measurement and pacing
+// ============================================================================
+
+// Frame times come from QueryPerformanceCounter. Pacing sleeps on a
+// high-resolution waitable timer (Windows 10 1803+); older systems get a
+// plain waitable timer with the system timer raised to 1ms by
+// timeBeginPeriod. Either way the last TIMER_SPIN_US before the deadline
+// is busy-waited, so frames start on time instead of a scheduler tick late.
+// Deadlines advance by whole frame periods, so rounding never accumulates.
+typedef struct {
+    LONGLONG freq;
+    LONGLONG last;          // counter at the previous frame_clock_tick
+    LONGLONG period;        // counter ticks per frame
+    LONGLONG deadline;      // counter value the current frame ends at
+    HANDLE timer;
+    bool period_raised;     // timeBeginPeriod(1) in effect
+} FrameClock;
+
+FrameClock frame_clock;
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002   // older SDK headers
+#endif
+
+static inline LONGLONG qpc_now(void) {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
+
+// Paces at the display's refresh rate when GDI reports one
+void frame_clock_init(HDC dc) {
+    FrameClock *fc = &frame_clock;
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    fc->freq = f.QuadPart;
+    int hz = GetDeviceCaps(dc, VREFRESH);
+    if (hz <= 1) hz = FPS;
+    fc->period = fc->freq / hz;
+    fc->timer = CreateWaitableTimerExA(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!fc->timer) {
+        fc->period_raised = timeBeginPeriod(1) == 0;
+        fc->timer = CreateWaitableTimer(NULL, TRUE, NULL);
+    }
+    fc->last = qpc_now();
+    fc->deadline = fc->last + fc->period;
+    printf("Pacing at %d Hz\n", hz);
+}
+
+void frame_clock_free(void) {
+    if (frame_clock.timer) CloseHandle(frame_clock.timer);
+    if (frame_clock.period_raised) timeEndPeriod(1);
+    memset(&frame_clock, 0, sizeof(frame_clock));
+}
+
+// Seconds since the previous call
+double frame_clock_tick(void) {
+    FrameClock *fc = &frame_clock;
+    LONGLONG now = qpc_now();
+    double dt = (double)(now - fc->last) / (double)fc->freq;
+    fc->last = now;
+    return dt;
+}
+
+// Blocks until the current frame's deadline, then sets the next one
+void frame_clock_wait(void) {
+    FrameClock *fc = &frame_clock;
+    LONGLONG spin = fc->freq * TIMER_SPIN_US / 1000000;
+    LONGLONG now = qpc_now();
+    if (fc->timer && fc->deadline - now > spin) {
+        LARGE_INTEGER due;
+        due.QuadPart = -((fc->deadline - now - spin) * 10000000 / fc->freq);  // relative, 100ns units
+        if (SetWaitableTimer(fc->timer, &due, 0, NULL, NULL, FALSE)) 
+            WaitForSingleObject(fc->timer, INFINITE);
+    }
+    while ((now = qpc_now()) < fc->deadline) {
+        // spin out the remainder
+    }
+    fc->deadline += fc->period;
+    if (fc->deadline <= now) fc->deadline = now + fc->period;  // fell behind: don't burst to catch up
+}
+
 // ============================================================================
 // WINDOWS MESSAGE HANDLING
 // ============================================================================
@@ -436,9 +651,13 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         case WM_PAINT: {
             PAINTSTRUCT ps;
             HDC hdc = BeginPaint(hwnd, &ps);
+            if (back_buffer.dc) present_frame(hdc);
             EndPaint(hwnd, &ps);
             return 0;
         }
+            
+        case WM_ERASEBKGND:
+            return 1;   // every frame repaints the whole client area
     }
     return DefWindowProc(hwnd, uMsg, wParam, lParam);
 }
@@ -456,6 +675,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     wc.hInstance = hInstance;
     wc.lpszClassName = CLASS_NAME;
     wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wc.style = CS_OWNDC;
     
     RegisterClass(&wc);
     
@@ -472,33 +692,32 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         return 0;
     }
     
-    ShowWindow(hwnd, nCmdShow);
-    
-    // Initialize random
-    srand(time(NULL));
+    window_dc = GetDC(hwnd);
+    if (!back_buffer_init(hwnd)) {
+        MessageBox(NULL, "Back buffer creation failed!", "Error", MB_OK | MB_ICONERROR);
+        return 0;
+    }
     
-    // Initialize game objects
-    Ball ball;
-    Paddle paddle;
-    Brick bricks[BRICK_ROWS][BRICK_COLS];
-    GameState state;
+    ShowWindow(hwnd, nCmdShow);
     
-    init_ball(&ball);
-    init_paddle(&paddle);
-    init_bricks(bricks);
-    init_game_state(&state);
+    // Initialize game: straight into level 1 with the ball on the paddle
+    init_game(&game, &win_backend, (uint32_t)time(NULL), 0);
+    reset_game(&game);
+    ark_command(&game, CMD_START);
+    persist_start(load_high_score());
     
     // Print controls
     printf("\n=== ARKANOID GAME ===\n");
     printf("Controls:\n");
     printf("  Arrow Keys / A,D - Move paddle\n");
+    printf("  Space - Launch ball / pause\n");
     printf("  P - Pause\n");
     printf("  R - Restart (when game over)\n");
     printf("  ESC - Quit\n\n");
     
     // Game loop
     MSG msg = {0};
-    DWORD last_time = GetTickCount();
+    frame_clock_init(window_dc);
     
     while (running) {
         // Handle Windows messages
@@ -512,18 +731,15 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
                 if (msg.wParam == VK_ESCAPE) {
                     running = false;
                 }
-                if (msg.wParam == 'P' || msg.wParam == VK_SPACE) {
-                    if (!state.game_over && !state.victory) {
-                        state.paused = !state.paused;
-                    }
+                if (msg.wParam == 'P') {
+                    ark_command(&game, CMD_PAUSE);
+                }
+                if (msg.wParam == VK_SPACE && !game_finished(&game)) {
+                    ark_command(&game, CMD_SPACE);
                 }
-                if (msg.wParam == 'R') {
-                    if (state.game_over || state.victory) {
-                        init_ball(&ball);
-                        init_paddle(&paddle);
-                        init_bricks(bricks);
-                        init_game_state(&state);
-                    }
+                if (msg.wParam == 'R' && game_finished(&game)) {
+                    ark_command(&game, CMD_RESET);
+                    ark_command(&game, CMD_START);
                 }
             }
             
@@ -531,51 +747,17 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
             DispatchMessage(&msg);
         }
         
-        // Handle input
-        handle_paddle_input(&paddle, &state);
-        
-        // Update game logic
-        update_ball(&ball, &paddle, bricks, &state);
-        
-        // Render
-        hdc = GetDC(hwnd);
-        
-        // Clear background
-        RECT rect;
-        GetClientRect(hwnd, &rect);
-        HBRUSH bgBrush = CreateSolidBrush(RGB(0, 0, 0));
-        FillRect(hdc, &rect, bgBrush);
-        DeleteObject(bgBrush);
-        
-        // Draw game elements
-        render_bricks(hdc, bricks);
-        render_paddle(hdc, &paddle);
-        render_ball(hdc, &ball);
-        render_ui(hdc, &state);
-        
-        // Draw overlays
-        if (state.paused) render_pause(hdc);
-        if (state.game_over) {
-            render_game_over(hdc, &state);
-            save_score(state.score);
-        }
-        if (state.victory) {
-            render_victory(hdc, &state);
-            save_score(state.score);
-        }
-        
-        ReleaseDC(hwnd, hdc);
+        // Input, fixed-step updates for the real time elapsed, render
+        ark_frame(&game, frame_clock_tick(), 1.0 / SIM_TICK_HZ);
         
         // Frame rate control
-        DWORD current_time = GetTickCount();
-        DWORD elapsed = current_time - last_time;
-        if (elapsed < FRAME_DELAY) {
-            Sleep(FRAME_DELAY - elapsed);
-        }
-        last_time = GetTickCount();
+        frame_clock_wait();
     }
     
-    printf("\nFinal Score: %d\n", state.score);
+    persist_stop();
+    back_buffer_free();
+    frame_clock_free();
+    printf("\nFinal Score: %d\n", game.game_state.score);
     printf("Thanks for playing!\n\n");
     
     return 0;
@@ -0,0 +1,1334 @@
+/* =====================================================================
+   ARKANOID SIMULATION CORE - shared by every front end
+   =====================================================================
+   
+   Platform-agnostic game logic: no SDL, GDI or file I/O in here. All game
+   state lives in a Game context that the caller owns and passes in, so one
+   process can run any number of games (the SDL build's headless workers
+   each own one). Front ends plug in through ArkBackend:
+   - level source (level files, packs), end-of-game hook (persistence)
+   - audio: one play_sfx call per sound event drained each frame
+   - input and renderer callbacks, used by the ark_frame() driver
+   A front end with its own loop (the SDL build, for replay and late-
+   latched input) may skip ark_frame and call update_engine directly.
+   Training code drives batches of games through the ArkEnvs step/observe
+   API at the end of this file instead.
+   
+   Single header: include it anywhere, and define ARK_CORE_IMPLEMENTATION
+   in exactly one translation unit before including it. Geometry and
+   tuning are compile-time macros; define any of the CONFIG values below
+   before the include to override them (see arkanoid.c).
+   
+   ===================================================================== */
+#ifndef ARKANOID_CORE_H
+#define ARKANOID_CORE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* --------------------- CONFIG --------------------- */
+#ifndef WINDOW_WIDTH
+#define WINDOW_WIDTH 960
+#endif
+#ifndef WINDOW_HEIGHT
+#define WINDOW_HEIGHT 640
+#endif
+
+#ifndef PADDLE_WIDTH
+#define PADDLE_WIDTH 140
+#endif
+#ifndef PADDLE_HEIGHT
+#define PADDLE_HEIGHT 18
+#endif
+#ifndef PADDLE_Y_OFFSET
+#define PADDLE_Y_OFFSET 64
+#endif
+#ifndef PADDLE_SPEED
+#define PADDLE_SPEED 800.0f
+#endif
+/* a wide-paddle pickup adds this much, up to half the window */
+#ifndef PADDLE_GROW
+#define PADDLE_GROW 40
+#endif
+
+#ifndef BALL_SIZE
+#define BALL_SIZE 14
+#endif
+#ifndef BALL_SPEED_INITIAL
+#define BALL_SPEED_INITIAL 420.0f
+#endif
+#ifndef BALL_SPEED_GROWTH
+#define BALL_SPEED_GROWTH 1.0f
+#endif
+/* every brick speeds the ball up a little; a big board would otherwise
+   run it past any sensible speed */
+#ifndef BALL_SPEED_MAX
+#define BALL_SPEED_MAX (BALL_SPEED_INITIAL * 4)
+#endif
+/* power-ups dropped by special bricks are square */
+#ifndef COLLECTIBLE_SIZE
+#define COLLECTIBLE_SIZE 20
+#endif
+
+/* Bricks sit on a grid of BRICK_WIDTH x BRICK_ROW_PITCH cells starting at
+   (BRICK_OFFSET_X, BRICK_OFFSET_Y); each brick is its cell minus padding. */
+#ifndef BRICK_COLUMNS
+#define BRICK_COLUMNS 12
+#endif
+#ifndef BRICK_ROWS
+#define BRICK_ROWS 7
+#endif
+#ifndef BRICK_WIDTH
+#define BRICK_WIDTH (WINDOW_WIDTH / BRICK_COLUMNS)
+#endif
+#ifndef BRICK_HEIGHT
+#define BRICK_HEIGHT 28
+#endif
+#ifndef BRICK_PADDING
+#define BRICK_PADDING 4
+#endif
+#ifndef BRICK_OFFSET_X
+#define BRICK_OFFSET_X 0
+#endif
+#ifndef BRICK_OFFSET_Y
+#define BRICK_OFFSET_Y 80
+#endif
+#ifndef BRICK_ROW_PITCH
+#define BRICK_ROW_PITCH (BRICK_HEIGHT + BRICK_PADDING)
+#endif
+/* points per brick and palette index for the built-in layout */
+#ifndef BRICK_SCORE
+#define BRICK_SCORE(row) ((void)(row), 10)
+#endif
+#ifndef BRICK_COLOR
+#define BRICK_COLOR(row, col, level) (((row) + (col) + (level)) % 10)
+#endif
+/* BRICK_ROWS x BRICK_COLUMNS is only the default grid: a level may bring
+   its own, up to BOARD_MAX_ROWS x BOARD_MAX_COLS. The field keeps the
+   default grid's width; rows keep BRICK_ROW_PITCH until the field would
+   pass BOARD_MAX_FIELD_H, then shrink to fit. */
+#ifndef BOARD_MAX_ROWS
+#define BOARD_MAX_ROWS 256
+#endif
+#ifndef BOARD_MAX_COLS
+#define BOARD_MAX_COLS 256
+#endif
+#ifndef BOARD_MAX_FIELD_H
+#define BOARD_MAX_FIELD_H (WINDOW_HEIGHT / 2)
+#endif
+/* dead bricks queued for the renderer before it redraws the whole field */
+#ifndef BOARD_DIRTY_MAX
+#define BOARD_DIRTY_MAX 256
+#endif
+
+#ifndef MAX_LEVELS
+#define MAX_LEVELS 10
+#endif
+#ifndef STARTING_LIVES
+#define STARTING_LIVES 3
+#endif
+
+#ifndef MAX_PARTICLES
+#define MAX_PARTICLES 65536
+#endif
+#ifndef PARTICLE_GRAVITY
+#define PARTICLE_GRAVITY 200.0f
+#endif
+#ifndef MAX_COLLECTIBLES
+#define MAX_COLLECTIBLES 8
+#endif
+#ifndef MAX_BALLS
+#define MAX_BALLS 512
+#endif
+#ifndef MULTIBALL_SPLIT
+#define MULTIBALL_SPLIT 3       /* each live ball becomes this many */
+#endif
+#define BALL_HASH_CELL 32       /* >= BALL_SIZE, so touching balls share or neighbour a cell */
+#define BALL_HASH_COLS (WINDOW_WIDTH / BALL_HASH_CELL + 1)
+#define BALL_HASH_ROWS (WINDOW_HEIGHT / BALL_HASH_CELL + 1)
+
+#ifndef SIM_TICK_HZ
+#define SIM_TICK_HZ 120
+#endif
+#define SIM_MIN_TICK_HZ 30
+#define SIM_MAX_TICK_HZ 1000
+#define SIM_MAX_FRAME_TIME 0.25
+#define SIM_MAX_TICKS_PER_FRAME 16
+#define SWEEP_MAX_BOUNCES 8
+#define SWEEP_MAX_CONTACTS 8
+#define SWEEP_EPSILON 1e-5f
+
+#ifndef ARK_OBS_BALLS
+#define ARK_OBS_BALLS 4         /* balls reported per observation */
+#endif
+#define ARK_ENV_CHUNK 16        /* envs per parallel_for job */
+
+/* Optional profiler scopes around the hot phases of update_engine. */
+#ifndef ARK_PROF_BEGIN
+#define ARK_PROF_BEGIN(phase) ((void)0)
+#define ARK_PROF_END(phase) ((void)0)
+#endif
+
+/* --------------------- TYPES --------------------- */
+typedef struct { float x, y, w, h; } RectF;
+/* The brick field. A brick's rect follows from its cell, so each brick is
+   just one bit in the alive mask (bit r * cols + c) and one LEVEL_CELL_*
+   byte holding its type and resolved palette index. Storage is sized for
+   the largest board; rows and cols change as levels load. */
+#define BOARD_MAX_CELLS (BOARD_MAX_ROWS * BOARD_MAX_COLS)
+#define BOARD_WORDS ((BOARD_MAX_CELLS + 63) / 64)
+typedef struct {
+    int rows, cols;
+    uint32_t serial;            /* bumped by board_layout: copies can spot a new level */
+    float cell_w, cell_h;       /* grid pitch */
+    float brick_w, brick_h;     /* brick inside its cell */
+    float inset_x;
+    uint64_t alive[BOARD_WORDS];
+    uint8_t cells[BOARD_MAX_CELLS];
+    /* brick-layer invalidation, set by reset_level and break_brick */
+    uint32_t dirty[BOARD_DIRTY_MAX];
+    int dirty_count;
+    int dirty_all;
+} Board;
+typedef struct { RectF rect; float velocity_x; } Paddle;
+typedef struct { RectF rect; float vx, vy; float speed; int is_held; } Ball;
+typedef struct { int score; int lives; int level; int bricks_remaining; int is_paused; int is_running; int show_menu; } GameState;
+/* Structure-of-arrays particle pool. Live particles are packed in [0, count);
+   spawning appends and dying swaps the last live particle into the hole, so
+   both are O(1) and the update loops never touch dead slots. The hot float
+   arrays are SIMD-aligned and capacity is a multiple of 4. */
+typedef struct {
+    float *x, *y, *vx, *vy, *life, *max_life;
+    uint8_t *color;             /* palette index, mapped by the renderer */
+    int count;
+    int capacity;
+    void *block;
+} ParticleSystem;
+typedef enum { COLLECT_WIDE_PADDLE, COLLECT_MULTIBALL } CollectibleType;
+typedef struct { RectF rect; float vx, vy; int alive; int type; } Collectible;
+/* Uniform grid over ball centres, rebuilt by counting sort each tick:
+   cell_start[c]..cell_start[c+1] indexes ids[] for the balls in cell c. */
+typedef struct {
+    uint16_t cell_start[BALL_HASH_COLS * BALL_HASH_ROWS + 1];
+    uint16_t ids[MAX_BALLS];
+} BallHash;
+/* Sound events raised by the simulation; see sfx_push / ark_drain_sfx. */
+typedef enum { SFX_WALL, SFX_PADDLE, SFX_BRICK, SFX_LIFE_LOST, SFX_COUNT } SfxType;
+
+/* Everything the player does besides moving the paddle; see ark_command. */
+typedef enum { CMD_NONE, CMD_START, CMD_SPACE, CMD_MENU, CMD_RESET, CMD_PAUSE } GameCommand;
+
+typedef struct Game Game;
+
+/* Front-end hooks. Any pointer may be NULL; the core then falls back to its
+   built-in level layout or simply skips the call. `user` is passed back
+   untouched. */
+typedef struct ArkBackend {
+    void *user;
+    /* cells for `level` (see LEVEL_CELL_*), or NULL for the built-in
+       layout. *rows and *cols come in as the default grid and may be
+       changed up to BOARD_MAX_*; `scratch` holds BOARD_MAX_CELLS bytes */
+    const uint8_t *(*level_cells)(void *user, int level, uint8_t *scratch, int *rows, int *cols);
+    /* the run just ended, lost or won; final score is in g->game_state */
+    void (*game_over)(void *user, Game *g);
+    void (*play_sfx)(void *user, SfxType sfx);
+    void (*render)(void *user, const Game *g, float alpha);
+    void (*poll_input)(void *user, Game *g);
+} ArkBackend;
+
+/* One complete game instance. Nothing in the core touches globals, so a
+   front end may run any number of these side by side. */
+struct Game {
+    Paddle paddle;
+    /* live balls packed in [0, ball_count); losing one swaps the last into
+       its slot, like the particle pool. balls[0] is the one held for serve. */
+    Ball balls[MAX_BALLS];
+    int ball_count;
+    BallHash ball_hash;
+    Board board;
+    GameState game_state;
+    ParticleSystem particles;
+    Collectible collectibles[MAX_COLLECTIBLES];
+    int high_score;
+    RectF ball_prev_rect[MAX_BALLS];
+    RectF paddle_prev_rect;
+    uint32_t rng;         /* gameplay stream: serve angles, specials, pickups */
+    uint32_t fx_rng;      /* cosmetic stream: particles; never feeds back into play */
+    uint32_t sfx_pending; /* one bit per SfxType raised since the last ark_drain_sfx */
+    int headless; /* no audio, no cosmetic effects, no score files */
+    int fx_density;       /* percent of each particle burst spawned; front ends lower it under load */
+    int ball_collisions;  /* balls bounce off each other */
+    double sim_accumulator; /* ark_frame: time not yet simulated */
+    const ArkBackend *backend;
+};
+
+/* --------------------- API --------------------- */
+/* Level cells, one byte each: low 2 bits LEVEL_CELL_* type, high nibble a
+   palette index or LEVEL_COLOR_DEFAULT for the BRICK_COLOR ramp. */
+#define LEVEL_CELL_EMPTY 0
+#define LEVEL_CELL_BRICK 1
+#define LEVEL_CELL_SPECIAL 2
+#define LEVEL_COLOR_DEFAULT 0xF
+
+static inline int brick_index(const Board *b, int row, int col) {
+    return row * b->cols + col;
+}
+
+static inline int brick_alive(const Board *b, int i) {
+    return (int)(b->alive[i >> 6] >> (i & 63)) & 1;
+}
+
+static inline int brick_color(const Board *b, int i) {
+    return b->cells[i] >> 4;
+}
+
+static inline RectF brick_rect(const Board *b, int row, int col) {
+    RectF r = { BRICK_OFFSET_X + col * b->cell_w + b->inset_x, BRICK_OFFSET_Y + row * b->cell_h,
+                b->brick_w, b->brick_h };
+    return r;
+}
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+static inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(x);
+#else
+    x -= (x >> 1) & 0x5555555555555555ull;
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* index of the lowest set bit; x must be non-zero */
+static inline int ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (int)i;
+#else
+    int n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+/* First live brick index in [from, end), or end. Skips empty stretches a
+   whole mask word at a time, so sparse boards walk fast:
+     for (i = board_next_alive(b, 0, n); i < n; i = board_next_alive(b, i + 1, n)) */
+static inline int board_next_alive(const Board *b, int from, int end) {
+    while (from < end) {
+        uint64_t w = b->alive[from >> 6] >> (from & 63);
+        if (w) {
+            int i = from + ctz64(w);
+            return i < end ? i : end;
+        }
+        from = (from | 63) + 1;
+    }
+    return end;
+}
+
+/* xorshift32: per-game state so headless workers stay independent and reproducible. */
+static inline uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13; 
+    x ^= x >> 17; 
+    x ^= x << 5;
+    return *state = x;
+}
+
+static inline uint32_t game_rand(Game *g) { 
+    return xorshift32(&g->rng); 
+}
+
+static inline uint32_t fx_rand(Game *g) { 
+    return xorshift32(&g->fx_rng); 
+}
+
+static inline void game_seed(Game *g, uint32_t seed) {
+    g->rng = seed ? seed : 0x9E3779B9u;
+    g->fx_rng = (seed ^ 0x85EBCA6Bu) ? (seed ^ 0x85EBCA6Bu) : 1u;
+}
+
+void init_game(Game *g, const ArkBackend *backend, uint32_t seed, int headless);
+void reset_game(Game *g);
+void reset_level(Game *g, int level);
+void reset_balls(Game *g);
+void decode_level_cells(Game *g, int level, const uint8_t *cells, int rows, int cols);
+void board_layout(Board *b, int rows, int cols);
+int board_alive_count(const Board *b);
+void snap_interpolation_state(Game *g);
+void clamp_paddle_position(Game *g);
+int rect_overlap(const RectF *a, const RectF *b);
+int brick_cells_for_rect(const Board *b, const RectF *a, int *r0, int *r1, int *c0, int *c1);
+
+int particles_init(ParticleSystem *ps, int capacity);
+void particles_free(ParticleSystem *ps);
+void spawn_particles(Game *g, float x, float y, uint8_t color, int count);
+void update_particles(Game *g, float dt);
+
+void serve_ball(Game *g);
+void spawn_multiball(Game *g);
+void update_collectibles(Game *g, float dt);
+void add_score_for_brick(Game *g, int row, int col);
+void break_brick(Game *g, Ball *ball, int r, int c);
+int sweep_aabb(const RectF *a, float dx, float dy, const RectF *b, float *toi, float *nx, float *ny);
+void step_ball(Game *g, Ball *ball, float dt);
+void collide_balls(Game *g);
+void update_engine(Game *g, float dt);
+
+int ark_command(Game *g, GameCommand cmd);
+void ark_tick(Game *g, float dt);
+void ark_drain_sfx(Game *g);
+int ark_frame(Game *g, double frame_time, double tick_dt);
+
+/* --------------------- ENVIRONMENTS --------------------- */
+/* Step/observe API for training paddle agents on the real rules: N
+   independent headless games advanced one fixed tick per ark_envs_step,
+   each writing an observation into caller memory. Nothing is allocated
+   after ark_envs_create. A finished episode (game over, all levels
+   cleared, or max_ticks) reports done or truncated once; the env starts
+   a new episode at its next step. */
+typedef enum { ARK_ACT_NOOP, ARK_ACT_LEFT, ARK_ACT_RIGHT, ARK_ACT_FIRE } ArkAction;
+
+typedef struct {
+    float paddle_x, paddle_w;           /* left edge and width, px */
+    float ball[ARK_OBS_BALLS][4];       /* x, y of the top-left corner, vx, vy in px/s */
+    int32_t ball_count;                 /* live balls; slots past ARK_OBS_BALLS are dropped */
+    int32_t score, lives, level, bricks_remaining;
+    float reward;                       /* score gained by this step */
+    uint16_t rows, cols;                /* layout of this env's bits in the brick buffer */
+    uint8_t done;                       /* lost the last life or cleared MAX_LEVELS */
+    uint8_t truncated;                  /* hit max_ticks */
+    uint8_t held;                       /* ball waiting on the paddle for ARK_ACT_FIRE */
+    uint8_t pad;
+} ArkObs;
+
+/* Runs job(ctx, 0..count-1), in any order and on any threads, returning
+   when all have finished. A NULL runner steps on the calling thread. */
+typedef struct ArkEnvRunner {
+    void *user;
+    void (*parallel_for)(void *user, int count, void (*job)(void *ctx, int index), void *ctx);
+} ArkEnvRunner;
+
+typedef struct {
+    int num_envs;
+    uint32_t seed;                      /* env i is seeded as the headless game i would be */
+    int tick_hz;                        /* 0: SIM_TICK_HZ */
+    int brick_words;                    /* brick buffer stride per env; 0: fits the built-in board */
+    uint64_t max_ticks;                 /* episode length cap; 0: none */
+    int ball_collisions;
+    /* level source; its hooks are called from the runner's threads */
+    const ArkBackend *backend;
+    const ArkEnvRunner *runner;
+} ArkEnvConfig;
+
+typedef struct { Game game; uint64_t ticks; int need_reset; } ArkEnvSlot;
+
+typedef struct {
+    ArkEnvSlot *slots;
+    int num_envs;
+    int brick_words;
+    float dt;
+    uint64_t max_ticks;
+    const ArkEnvRunner *runner;
+    /* arguments of the step in flight, read by the jobs */
+    const uint8_t *actions;
+    ArkObs *obs;
+    uint64_t *bricks;
+} ArkEnvs;
+
+/* NULL if out of memory. All envs start reset; call ark_envs_reset for
+   their first observation. */
+ArkEnvs *ark_envs_create(const ArkEnvConfig *cfg);
+void ark_envs_free(ArkEnvs *e);
+/* obs holds num_envs entries and bricks (may be NULL) num_envs *
+   brick_words words; env i's bits start at bricks + i * brick_words,
+   bit r * cols + c as in Board.alive, cut off past the stride. */
+void ark_envs_reset(ArkEnvs *e, ArkObs *obs, uint64_t *bricks);
+/* actions: one ArkAction per env, held for this tick */
+void ark_envs_step(ArkEnvs *e, const uint8_t *actions, ArkObs *obs, uint64_t *bricks);
+
+#ifdef ARK_CORE_IMPLEMENTATION
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PARTICLES_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PARTICLES_NEON 1
+#endif
+
+/* 16-byte aligned block for the SIMD particle lanes; the offset back to the
+   malloc pointer is stored just below the returned address. */
+static void *ark_aligned_alloc(size_t size) {
+    unsigned char *raw = (unsigned char *)malloc(size + 16 + sizeof(void *));
+    if (!raw) return NULL;
+    uintptr_t p = ((uintptr_t)(raw + sizeof(void *)) + 15) & ~(uintptr_t)15;
+    ((void **)p)[-1] = raw;
+    return (void *)p;
+}
+
+static void ark_aligned_free(void *p) {
+    if (p) free(((void **)p)[-1]);
+}
+
+/* Previous-tick positions for render interpolation. Call after any
+   teleport (level reset, serve) so the renderer doesn't lerp across it. */
+void snap_interpolation_state(Game *g) {
+    for (int i = 0; i < g->ball_count; i++) g->ball_prev_rect[i] = g->balls[i].rect;
+    g->paddle_prev_rect = g->paddle.rect;
+}
+
+void clamp_paddle_position(Game *g) { 
+    if (g->paddle.rect.x < 0) g->paddle.rect.x = 0; 
+    if (g->paddle.rect.x + g->paddle.rect.w > WINDOW_WIDTH) 
+        g->paddle.rect.x = WINDOW_WIDTH - g->paddle.rect.w; 
+}
+
+int rect_overlap(const RectF *a, const RectF *b) { 
+    return !(a->x + a->w <= b->x || b->x + b->w <= a->x || 
+             a->y + a->h <= b->y || b->y + b->h <= a->y); 
+}
+
+/* Broadphase: bricks sit on a regular grid, so only the cells spanned by an
+   AABB can touch it. Returns 0 if the rect lies outside the brick field. */
+int brick_cells_for_rect(const Board *b, const RectF *a, int *r0, int *r1, int *c0, int *c1) {
+    if (b->rows <= 0) return 0;
+    *c0 = (int)floorf((a->x - BRICK_OFFSET_X) / b->cell_w);
+    *c1 = (int)floorf((a->x + a->w - BRICK_OFFSET_X) / b->cell_w);
+    *r0 = (int)floorf((a->y - BRICK_OFFSET_Y) / b->cell_h);
+    *r1 = (int)floorf((a->y + a->h - BRICK_OFFSET_Y) / b->cell_h);
+    if (*r1 < 0 || *r0 >= b->rows || *c1 < 0 || *c0 >= b->cols) return 0;
+    if (*r0 < 0) *r0 = 0;
+    if (*c0 < 0) *c0 = 0;
+    if (*r1 >= b->rows) *r1 = b->rows - 1;
+    if (*c1 >= b->cols) *c1 = b->cols - 1;
+    return 1;
+}
+
+/* Sizes the grid and derives its geometry. The default grid comes out at
+   exactly the BRICK_* cell and brick sizes; others scale them. */
+void board_layout(Board *b, int rows, int cols) {
+    if (rows < 1) rows = 1;
+    if (cols < 1) cols = 1;
+    if (rows > BOARD_MAX_ROWS) rows = BOARD_MAX_ROWS;
+    if (cols > BOARD_MAX_COLS) cols = BOARD_MAX_COLS;
+    b->rows = rows;
+    b->cols = cols;
+    b->serial++;
+    b->cell_w = (float)(BRICK_COLUMNS * BRICK_WIDTH) / cols;
+    b->cell_h = rows * BRICK_ROW_PITCH <= BOARD_MAX_FIELD_H ? (float)BRICK_ROW_PITCH : (float)BOARD_MAX_FIELD_H / rows;
+    float sx = b->cell_w / BRICK_WIDTH, sy = b->cell_h / BRICK_ROW_PITCH;
+    b->brick_w = (BRICK_WIDTH - BRICK_PADDING) * sx;
+    b->brick_h = (BRICK_HEIGHT - BRICK_PADDING) * sy;
+    b->inset_x = (BRICK_PADDING / 2) * sx;
+    memset(b->alive, 0, ((size_t)rows * cols + 63) / 64 * sizeof(uint64_t));
+    b->dirty_count = 0;
+    b->dirty_all = 1;
+}
+
+int board_alive_count(const Board *b) {
+    int words = (b->rows * b->cols + 63) / 64, n = 0;
+    for (int i = 0; i < words; i++) n += popcount64(b->alive[i]);
+    return n;
+}
+
+static inline void board_set_alive(Board *b, int i) {
+    b->alive[i >> 6] |= 1ull << (i & 63);
+}
+
+/* Decodes packed cells into the board; `cells` may be g->board.cells. */
+void decode_level_cells(Game *g, int level, const uint8_t *cells, int rows, int cols) {
+    Board *bd = &g->board;
+    board_layout(bd, rows, cols);
+    for (int r = 0; r < bd->rows; r++) {
+        for (int c = 0; c < bd->cols; c++) {
+            int i = brick_index(bd, r, c);
+            int type = cells[r * cols + c] & 3, color = cells[r * cols + c] >> 4;
+            if (color == LEVEL_COLOR_DEFAULT) color = BRICK_COLOR(r, c, level) & 0xF;
+            bd->cells[i] = (uint8_t)(type | color << 4);
+            if (type != LEVEL_CELL_EMPTY) board_set_alive(bd, i);
+        }
+    }
+    g->game_state.bricks_remaining = board_alive_count(bd);
+}
+
+/* Back to a single ball held on the paddle. */
+void reset_balls(Game *g) {
+    Ball *b = &g->balls[0];
+    b->rect.w = BALL_SIZE; 
+    b->rect.h = BALL_SIZE;
+    b->rect.x = g->paddle.rect.x + (g->paddle.rect.w - b->rect.w) / 2.0f; 
+    b->rect.y = g->paddle.rect.y - b->rect.h - 2; 
+    b->vx = 0; b->vy = -1; 
+    b->speed = BALL_SPEED_INITIAL; 
+    b->is_held = 1;
+    g->ball_count = 1;
+}
+
+void reset_level(Game *g, int level) {
+    Board *bd = &g->board;
+    const uint8_t *cells = NULL;
+    int rows = BRICK_ROWS, cols = BRICK_COLUMNS;
+    /* the board's own cell bytes double as the hook's scratch; decoding
+       in place is safe since each cell only maps onto itself */
+    if (g->backend && g->backend->level_cells) 
+        cells = g->backend->level_cells(g->backend->user, level, bd->cells, &rows, &cols);
+    if (cells && rows > 0 && cols > 0 && rows <= BOARD_MAX_ROWS && cols <= BOARD_MAX_COLS) {
+        decode_level_cells(g, level, cells, rows, cols);
+    } else {
+        board_layout(bd, BRICK_ROWS, BRICK_COLUMNS);
+        for (int r = 0; r < BRICK_ROWS; r++) {
+            for (int c = 0; c < BRICK_COLUMNS; c++) {
+                int i = brick_index(bd, r, c), type = LEVEL_CELL_EMPTY;
+                if ((level <= 1) || ((r + c + level) % (1 + level / 2) != 0)) {
+                    type = (game_rand(g)%18==0) ? LEVEL_CELL_SPECIAL : LEVEL_CELL_BRICK;
+                    board_set_alive(bd, i);
+                }
+                bd->cells[i] = (uint8_t)(type | (BRICK_COLOR(r, c, level) & 0xF) << 4);
+            }
+        }
+        g->game_state.bricks_remaining = board_alive_count(bd);
+    }
+    g->paddle.rect.x = (WINDOW_WIDTH - g->paddle.rect.w) / 2.0f; 
+    g->paddle.rect.y = WINDOW_HEIGHT - PADDLE_Y_OFFSET;
+    reset_balls(g);
+    for (int ci=0; ci<MAX_COLLECTIBLES; ci++) 
+        g->collectibles[ci].alive = 0;
+    snap_interpolation_state(g);
+}
+
+/* Zero a game instance and set the fixed entity sizes. */
+void init_game(Game *g, const ArkBackend *backend, uint32_t seed, int headless) {
+    memset(g, 0, sizeof(*g));
+    game_seed(g, seed);
+    g->backend = backend;
+    g->headless = headless;
+    g->fx_density = 100;
+    g->paddle.rect.w = PADDLE_WIDTH; 
+    g->paddle.rect.h = PADDLE_HEIGHT; 
+    reset_balls(g);
+}
+
+void reset_game(Game *g) { 
+    g->game_state.score = 0; 
+    g->game_state.lives = STARTING_LIVES; 
+    g->game_state.level = 1; 
+    g->game_state.is_paused = 0; 
+    g->game_state.is_running = 1; 
+    g->game_state.show_menu = 1; 
+    reset_level(g, g->game_state.level); 
+}
+
+int particles_init(ParticleSystem *ps, int capacity) {
+    memset(ps, 0, sizeof(*ps));
+    capacity = (capacity + 3) & ~3;
+    if (capacity <= 0) return 1;
+    size_t n = (size_t)capacity;
+    ps->block = ark_aligned_alloc(n * (6 * sizeof(float) + sizeof(uint8_t)));
+    if (!ps->block) return 0;
+    float *f = (float *)ps->block;
+    ps->x = f; 
+    ps->y = f + n; 
+    ps->vx = f + 2*n; 
+    ps->vy = f + 3*n; 
+    ps->life = f + 4*n; 
+    ps->max_life = f + 5*n;
+    ps->color = (uint8_t *)(f + 6*n);
+    memset(ps->block, 0, n * 6 * sizeof(float));
+    ps->capacity = capacity;
+    return 1;
+}
+
+void particles_free(ParticleSystem *ps) {
+    if (ps->block) ark_aligned_free(ps->block);
+    memset(ps, 0, sizeof(*ps));
+}
+
+static inline void particle_kill(ParticleSystem *ps, int i) {
+    int last = --ps->count;
+    ps->x[i] = ps->x[last]; 
+    ps->y[i] = ps->y[last];
+    ps->vx[i] = ps->vx[last]; 
+    ps->vy[i] = ps->vy[last];
+    ps->life[i] = ps->life[last]; 
+    ps->max_life[i] = ps->max_life[last];
+    ps->color[i] = ps->color[last];
+}
+
+void spawn_particles(Game *g, float x, float y, uint8_t color, int count) {
+    ParticleSystem *ps = &g->particles;
+    if (g->headless) return;
+    count = (count * g->fx_density + 50) / 100;
+    if (count > ps->capacity - ps->count) count = ps->capacity - ps->count;
+    for (; count > 0; count--) {
+        int i = ps->count++;
+        ps->x[i] = x; 
+        ps->y[i] = y;
+        float ang = ((fx_rand(g)%360) * (M_PI/180.0f));
+        float sp = 60 + (fx_rand(g)%120);
+        ps->vx[i] = cosf(ang)*sp; 
+        ps->vy[i] = sinf(ang)*sp;
+        ps->life[i] = 0.0f; 
+        ps->max_life[i] = 0.5f + ((fx_rand(g)%100)/200.0f);
+        ps->color[i] = color; 
+    }
+}
+
+void update_particles(Game *g, float dt) {
+    ParticleSystem *ps = &g->particles;
+    int n4 = (ps->count + 3) & ~3; /* padding lanes are dead slots inside capacity */
+    int i = 0;
+#if defined(PARTICLES_SSE)
+    __m128 vdt = _mm_set1_ps(dt), vgrav = _mm_set1_ps(PARTICLE_GRAVITY * dt);
+    for (; i < n4; i += 4) {
+        __m128 vx = _mm_load_ps(ps->vx + i), vy = _mm_load_ps(ps->vy + i);
+        _mm_store_ps(ps->x + i, _mm_add_ps(_mm_load_ps(ps->x + i), _mm_mul_ps(vx, vdt)));
+        _mm_store_ps(ps->y + i, _mm_add_ps(_mm_load_ps(ps->y + i), _mm_mul_ps(vy, vdt)));
+        _mm_store_ps(ps->vy + i, _mm_add_ps(vy, vgrav));
+        _mm_store_ps(ps->life + i, _mm_add_ps(_mm_load_ps(ps->life + i), vdt));
+    }
+#elif defined(PARTICLES_NEON)
+    float32x4_t vdt = vdupq_n_f32(dt), vgrav = vdupq_n_f32(PARTICLE_GRAVITY * dt);
+    for (; i < n4; i += 4) {
+        float32x4_t vx = vld1q_f32(ps->vx + i), vy = vld1q_f32(ps->vy + i);
+        vst1q_f32(ps->x + i, vmlaq_f32(vld1q_f32(ps->x + i), vx, vdt));
+        vst1q_f32(ps->y + i, vmlaq_f32(vld1q_f32(ps->y + i), vy, vdt));
+        vst1q_f32(ps->vy + i, vaddq_f32(vy, vgrav));
+        vst1q_f32(ps->life + i, vaddq_f32(vld1q_f32(ps->life + i), vdt));
+    }
+#endif
+    for (; i < ps->count; i++) {
+        ps->x[i] += ps->vx[i] * dt; 
+        ps->y[i] += ps->vy[i] * dt; 
+        ps->vy[i] += PARTICLE_GRAVITY * dt;
+        ps->life[i] += dt; 
+    }
+    for (i = ps->count - 1; i >= 0; i--) 
+        if (ps->life[i] >= ps->max_life[i]) particle_kill(ps, i);
+}
+
+/* Multi-ball pickup: every live ball splits into MULTIBALL_SPLIT copies
+   fanned out around its heading, until the pool is full. */
+void spawn_multiball(Game *g) {
+    if (g->balls[0].is_held) serve_ball(g);
+    int n0 = g->ball_count;
+    for (int i = 0; i < n0; i++) {
+        for (int k = 1; k < MULTIBALL_SPLIT && g->ball_count < MAX_BALLS; k++) {
+            Ball *src = &g->balls[i];
+            Ball *b = &g->balls[g->ball_count];
+            float ang = (k & 1 ? 1.0f : -1.0f) * (float)((k + 1) / 2) * (25.0f * (float)M_PI / 180.0f);
+            float ca = cosf(ang), sa = sinf(ang);
+            *b = *src;
+            b->vx = src->vx * ca - src->vy * sa;
+            b->vy = src->vx * sa + src->vy * ca;
+            /* keep a vertical component so no copy skims the walls forever */
+            if (fabsf(b->vy) < 0.25f) {
+                b->vy = b->vy < 0 ? -0.25f : 0.25f;
+                b->vx = (b->vx < 0 ? -1.0f : 1.0f) * sqrtf(1.0f - b->vy * b->vy);
+            }
+            g->ball_prev_rect[g->ball_count] = b->rect;
+            g->ball_count++;
+        }
+    }
+}
+
+void update_collectibles(Game *g, float dt) {
+    for (int i=0;i<MAX_COLLECTIBLES;i++) {
+        if (!g->collectibles[i].alive) continue;
+        g->collectibles[i].rect.x += g->collectibles[i].vx * dt;
+        g->collectibles[i].rect.y += g->collectibles[i].vy * dt;
+        if (g->collectibles[i].rect.y > WINDOW_HEIGHT) 
+            g->collectibles[i].alive = 0;
+        RectF pr = g->collectibles[i].rect;
+        if (rect_overlap(&pr, &g->paddle.rect)) {
+            if (g->collectibles[i].type == COLLECT_WIDE_PADDLE) {
+                g->paddle.rect.w += PADDLE_GROW; 
+                if (g->paddle.rect.w > WINDOW_WIDTH/2) 
+                    g->paddle.rect.w = WINDOW_WIDTH/2; 
+                clamp_paddle_position(g);
+            }
+            else if (g->collectibles[i].type == COLLECT_MULTIBALL) 
+                spawn_multiball(g);
+            g->collectibles[i].alive = 0;
+        }
+    }
+}
+
+/* O(1) and mixer-free, so it is safe in headless workers: the bit is simply
+   never consumed there. Repeats within a frame collapse into one event. */
+static inline void sfx_push(Game *g, SfxType type) {
+    g->sfx_pending |= 1u << type;
+}
+
+void add_score_for_brick(Game *g, int row, int col) { 
+    (void)col; 
+    g->game_state.score += BRICK_SCORE(row); 
+}
+
+/* Brick-death event: every brick removal goes through here. */
+void break_brick(Game *g, Ball *ball, int r, int c) {
+    Board *bd = &g->board;
+    int i = brick_index(bd, r, c);
+    bd->alive[i >> 6] &= ~(1ull << (i & 63));
+    g->game_state.bricks_remaining--;
+    /* a brick dies once per level, so the queue needs no dedup */
+    if (bd->dirty_count < BOARD_DIRTY_MAX) bd->dirty[bd->dirty_count++] = (uint32_t)i;
+    else bd->dirty_all = 1;
+    
+    if ((bd->cells[i] & 3) == LEVEL_CELL_SPECIAL) {
+        RectF br = brick_rect(bd, r, c);
+        float cx = br.x + br.w/2.0f; 
+        float cy = br.y + br.h/2.0f;
+        for (int ci=0; ci<MAX_COLLECTIBLES; ci++) {
+            if (!g->collectibles[ci].alive) {
+                g->collectibles[ci].alive = 1; 
+                g->collectibles[ci].rect.x = cx - COLLECTIBLE_SIZE / 2; 
+                g->collectibles[ci].rect.y = cy - COLLECTIBLE_SIZE / 2; 
+                g->collectibles[ci].rect.w = COLLECTIBLE_SIZE; 
+                g->collectibles[ci].rect.h = COLLECTIBLE_SIZE; 
+                g->collectibles[ci].vx = 0; 
+                g->collectibles[ci].vy = 60.0f; 
+                g->collectibles[ci].type = game_rand(g) % 3 == 0 ? COLLECT_MULTIBALL : COLLECT_WIDE_PADDLE; 
+                break;
+            }
+        }
+        bd->cells[i] = (uint8_t)((bd->cells[i] & ~3) | LEVEL_CELL_BRICK);
+    }
+
+    add_score_for_brick(g, r,c);
+    sfx_push(g, SFX_BRICK);
+    spawn_particles(g, ball->rect.x + ball->rect.w/2, ball->rect.y + ball->rect.h/2, (uint8_t)brick_color(bd, i), 18);
+    ball->speed = fminf(ball->speed * 1.015f, BALL_SPEED_MAX); 
+}
+
+/* Swept AABB: time of impact in [0,1] of box `a` moving by (dx,dy) against
+   static box `b`, with the face normal that was hit. A box that already
+   overlaps at t=0 reports an immediate hit on its shallowest face. */
+int sweep_aabb(const RectF *a, float dx, float dy, const RectF *b, float *toi, float *nx, float *ny) {
+    if (rect_overlap(a, b)) {
+        float ol = (a->x + a->w) - b->x; 
+        float or = (b->x + b->w) - a->x; 
+        float ot = (a->y + a->h) - b->y; 
+        float ob = (b->y + b->h) - a->y; 
+        float m = fminf(fminf(ol, or), fminf(ot, ob));
+        *nx = 0; *ny = 0;
+        if (m == ol) *nx = -1; 
+        else if (m == or) *nx = 1; 
+        else if (m == ot) *ny = -1; 
+        else *ny = 1;
+        *toi = 0;
+        return 1;
+    }
+
+    float tx_entry, tx_exit, ty_entry, ty_exit;
+    if (dx > 0) { 
+        tx_entry = (b->x - (a->x + a->w)) / dx; 
+        tx_exit = ((b->x + b->w) - a->x) / dx; 
+    }
+    else if (dx < 0) { 
+        tx_entry = ((b->x + b->w) - a->x) / dx; 
+        tx_exit = (b->x - (a->x + a->w)) / dx; 
+    }
+    else {
+        if (a->x + a->w <= b->x || b->x + b->w <= a->x) return 0;
+        tx_entry = -FLT_MAX; 
+        tx_exit = FLT_MAX;
+    }
+    if (dy > 0) { 
+        ty_entry = (b->y - (a->y + a->h)) / dy; 
+        ty_exit = ((b->y + b->h) - a->y) / dy; 
+    }
+    else if (dy < 0) { 
+        ty_entry = ((b->y + b->h) - a->y) / dy; 
+        ty_exit = (b->y - (a->y + a->h)) / dy; 
+    }
+    else {
+        if (a->y + a->h <= b->y || b->y + b->h <= a->y) return 0;
+        ty_entry = -FLT_MAX; 
+        ty_exit = FLT_MAX;
+    }
+
+    float entry = fmaxf(tx_entry, ty_entry);
+    float exit = fminf(tx_exit, ty_exit);
+    if (entry > exit || entry < 0.0f || entry > 1.0f) return 0;
+    *toi = entry;
+    if (tx_entry > ty_entry) { 
+        *nx = dx > 0 ? -1.0f : 1.0f; 
+        *ny = 0; 
+    }
+    else { 
+        *nx = 0; 
+        *ny = dy > 0 ? -1.0f : 1.0f; 
+    }
+    return 1;
+}
+
+enum { CONTACT_WALL, CONTACT_PADDLE, CONTACT_BRICK };
+typedef struct { int kind; int r, c; float nx, ny; } Contact;
+
+typedef struct { 
+    float toi; 
+    int count; 
+    Contact list[SWEEP_MAX_CONTACTS]; 
+} ContactSet;
+
+/* Keep only the earliest contacts; ties (a seam between two bricks, a
+   corner between wall and ceiling) are resolved together. */
+static void contact_add(ContactSet *cs, float toi, int kind, int r, int c, float nx, float ny) {
+    if (toi < cs->toi - SWEEP_EPSILON) { 
+        cs->toi = toi; 
+        cs->count = 0; 
+    }
+    else if (toi > cs->toi + SWEEP_EPSILON) return;
+    if (cs->count >= SWEEP_MAX_CONTACTS) return;
+    Contact *k = &cs->list[cs->count++];
+    k->kind = kind; k->r = r; k->c = c; k->nx = nx; k->ny = ny;
+}
+
+static void paddle_bounce(Game *g, Ball *ball) {
+    float impact = ((ball->rect.x + ball->rect.w/2.0f) - (g->paddle.rect.x + g->paddle.rect.w/2.0f)) / (g->paddle.rect.w/2.0f);
+    if (impact < -1) impact = -1; 
+    if (impact > 1) impact = 1; 
+    float angle = impact * (75.0f * (M_PI/180.0f));
+    ball->vx = sinf(angle); 
+    ball->vy = -cosf(angle); 
+    ball->speed = fminf(ball->speed * BALL_SPEED_GROWTH, BALL_SPEED_MAX); 
+    ball->rect.y = g->paddle.rect.y - ball->rect.h; 
+    sfx_push(g, SFX_PADDLE);
+}
+
+/* Continuous ball motion for one tick: find the earliest time of impact among
+   walls, the paddle and the bricks along the swept path, advance to it,
+   respond, and continue with the rest of the tick. Candidates are visited in
+   a fixed order, so results are deterministic for a given input. */
+void step_ball(Game *g, Ball *ball, float dt) {
+    if (ball->is_held) { 
+        ball->rect.x = g->paddle.rect.x + (g->paddle.rect.w - ball->rect.w)/2.0f; 
+        ball->rect.y = g->paddle.rect.y - ball->rect.h - 2; 
+        return;
+    }
+
+    float remaining = dt;
+    for (int bounce = 0; bounce < SWEEP_MAX_BOUNCES && remaining > 0.0f; bounce++) {
+        float dx = ball->vx * ball->speed * remaining;
+        float dy = ball->vy * ball->speed * remaining;
+        ContactSet cs;
+        cs.toi = 1.0f; 
+        cs.count = 0;
+        float t, nx, ny;
+
+        if (dx < 0) contact_add(&cs, fmaxf(0.0f, -ball->rect.x / dx), CONTACT_WALL, 0, 0, 1, 0);
+        if (dx > 0) contact_add(&cs, fmaxf(0.0f, (WINDOW_WIDTH - ball->rect.w - ball->rect.x) / dx), CONTACT_WALL, 0, 0, -1, 0);
+        if (dy < 0) contact_add(&cs, fmaxf(0.0f, -ball->rect.y / dy), CONTACT_WALL, 0, 0, 0, 1);
+
+        if (dy > 0 && sweep_aabb(&ball->rect, dx, dy, &g->paddle.rect, &t, &nx, &ny)) 
+            contact_add(&cs, t, CONTACT_PADDLE, 0, 0, nx, ny);
+
+        RectF swept = { fminf(ball->rect.x, ball->rect.x + dx), fminf(ball->rect.y, ball->rect.y + dy),
+                        ball->rect.w + fabsf(dx), ball->rect.h + fabsf(dy) };
+        int r0, r1, c0, c1;
+        if (brick_cells_for_rect(&g->board, &swept, &r0, &r1, &c0, &c1)) {
+            for (int r=r0;r<=r1;r++) {
+                for (int c=c0;c<=c1;c++) {
+                    if (!brick_alive(&g->board, brick_index(&g->board, r, c))) continue;
+                    RectF br = brick_rect(&g->board, r, c);
+                    if (sweep_aabb(&ball->rect, dx, dy, &br, &t, &nx, &ny)) 
+                        contact_add(&cs, t, CONTACT_BRICK, r, c, nx, ny);
+                }
+            }
+        }
+
+        if (cs.count == 0 || cs.toi >= 1.0f) {
+            ball->rect.x += dx; 
+            ball->rect.y += dy;
+            return;
+        }
+
+        ball->rect.x += dx * cs.toi; 
+        ball->rect.y += dy * cs.toi;
+        remaining *= (1.0f - cs.toi);
+
+        int flip_x = 0, flip_y = 0, hit_paddle = 0, hit_wall = 0;
+        for (int i=0;i<cs.count;i++) {
+            Contact *k = &cs.list[i];
+            if (k->kind == CONTACT_PADDLE) { hit_paddle = 1; continue; }
+            if (k->kind == CONTACT_WALL) hit_wall = 1;
+            if (k->nx != 0) flip_x = (int)k->nx;
+            if (k->ny != 0) flip_y = (int)k->ny;
+            if (k->kind == CONTACT_BRICK) {
+                /* snap to the face so float error can't leave the ball inside */
+                RectF br = brick_rect(&g->board, k->r, k->c);
+                if (k->nx < 0) ball->rect.x = br.x - ball->rect.w;
+                if (k->nx > 0) ball->rect.x = br.x + br.w;
+                if (k->ny < 0) ball->rect.y = br.y - ball->rect.h;
+                if (k->ny > 0) ball->rect.y = br.y + br.h;
+            }
+        }
+        if (flip_x > 0) ball->vx = fabsf(ball->vx);
+        if (flip_x < 0) ball->vx = -fabsf(ball->vx);
+        if (flip_y > 0) ball->vy = fabsf(ball->vy);
+        if (flip_y < 0) ball->vy = -fabsf(ball->vy);
+        if (ball->rect.x < 0) ball->rect.x = 0;
+        if (ball->rect.x + ball->rect.w > WINDOW_WIDTH) ball->rect.x = WINDOW_WIDTH - ball->rect.w;
+        if (ball->rect.y < 0) ball->rect.y = 0;
+        if (hit_wall) sfx_push(g, SFX_WALL);
+        if (hit_paddle) paddle_bounce(g, ball);
+
+        for (int i=0;i<cs.count;i++) 
+            if (cs.list[i].kind == CONTACT_BRICK) break_brick(g, ball, cs.list[i].r, cs.list[i].c);
+    }
+}
+
+void serve_ball(Game *g) {
+    Ball *b = &g->balls[0];
+    float ang = ((int)(game_rand(g)%120)-60)*(M_PI/180.0f); 
+    b->vx = sinf(ang); 
+    b->vy = -fabsf(cosf(ang)); 
+    float m = sqrtf(b->vx*b->vx+b->vy*b->vy); 
+    b->vx/=m; 
+    b->vy/=m; 
+    b->is_held = 0; 
+}
+
+/* Optional ball-vs-ball pass (Game.ball_collisions). Balls are bucketed by
+   centre into BALL_HASH_CELL cells; each cell is tested against itself and
+   the four neighbours ahead of it, so every nearby pair is seen once.
+   Overlapping, approaching pairs exchange the velocity component along the
+   axis of least penetration and are pushed apart. */
+static void ball_pair_response(Ball *a, Ball *b) {
+    float ox = fminf(a->rect.x + a->rect.w, b->rect.x + b->rect.w) - fmaxf(a->rect.x, b->rect.x);
+    float oy = fminf(a->rect.y + a->rect.h, b->rect.y + b->rect.h) - fmaxf(a->rect.y, b->rect.y);
+    if (ox <= 0 || oy <= 0) return;
+    float avx = a->vx * a->speed, avy = a->vy * a->speed;
+    float bvx = b->vx * b->speed, bvy = b->vy * b->speed;
+    if (ox < oy) {
+        float side = a->rect.x < b->rect.x ? 1.0f : -1.0f;
+        if ((avx - bvx) * side <= 0) return;
+        float t = avx; avx = bvx; bvx = t;
+        a->rect.x -= side * ox * 0.5f; 
+        b->rect.x += side * ox * 0.5f;
+    } else {
+        float side = a->rect.y < b->rect.y ? 1.0f : -1.0f;
+        if ((avy - bvy) * side <= 0) return;
+        float t = avy; avy = bvy; bvy = t;
+        a->rect.y -= side * oy * 0.5f; 
+        b->rect.y += side * oy * 0.5f;
+    }
+    float ma = sqrtf(avx*avx + avy*avy), mb = sqrtf(bvx*bvx + bvy*bvy);
+    if (ma > 0) { a->vx = avx / ma; a->vy = avy / ma; a->speed = ma; }
+    if (mb > 0) { b->vx = bvx / mb; b->vy = bvy / mb; b->speed = mb; }
+    Ball *pair[2] = { a, b };
+    for (int i = 0; i < 2; i++) {
+        RectF *r = &pair[i]->rect;
+        if (r->x < 0) r->x = 0;
+        if (r->x + r->w > WINDOW_WIDTH) r->x = WINDOW_WIDTH - r->w;
+        if (r->y < 0) r->y = 0;
+    }
+}
+
+static int ball_hash_cell(const Ball *b) {
+    int cx = (int)((b->rect.x + b->rect.w * 0.5f) / BALL_HASH_CELL);
+    int cy = (int)((b->rect.y + b->rect.h * 0.5f) / BALL_HASH_CELL);
+    if (cx < 0) cx = 0; 
+    if (cx >= BALL_HASH_COLS) cx = BALL_HASH_COLS - 1;
+    if (cy < 0) cy = 0; 
+    if (cy >= BALL_HASH_ROWS) cy = BALL_HASH_ROWS - 1;
+    return cy * BALL_HASH_COLS + cx;
+}
+
+void collide_balls(Game *g) {
+    BallHash *h = &g->ball_hash;
+    static const int ahead[4][2] = { {1,0}, {-1,1}, {0,1}, {1,1} };
+    uint16_t cell_of[MAX_BALLS];
+    memset(h->cell_start, 0, sizeof(h->cell_start));
+    for (int i = 0; i < g->ball_count; i++) {
+        cell_of[i] = (uint16_t)ball_hash_cell(&g->balls[i]);
+        h->cell_start[cell_of[i] + 1]++;
+    }
+    for (int c = 0; c < BALL_HASH_COLS * BALL_HASH_ROWS; c++) h->cell_start[c + 1] += h->cell_start[c];
+    uint16_t fill[BALL_HASH_COLS * BALL_HASH_ROWS];
+    memcpy(fill, h->cell_start, sizeof(fill));
+    for (int i = 0; i < g->ball_count; i++) h->ids[fill[cell_of[i]]++] = (uint16_t)i;
+
+    for (int cy = 0; cy < BALL_HASH_ROWS; cy++) {
+        for (int cx = 0; cx < BALL_HASH_COLS; cx++) {
+            int c = cy * BALL_HASH_COLS + cx;
+            for (int i = h->cell_start[c]; i < h->cell_start[c + 1]; i++) {
+                Ball *a = &g->balls[h->ids[i]];
+                for (int j = i + 1; j < h->cell_start[c + 1]; j++) 
+                    ball_pair_response(a, &g->balls[h->ids[j]]);
+                for (int n = 0; n < 4; n++) {
+                    int nx = cx + ahead[n][0], ny = cy + ahead[n][1];
+                    if (nx < 0 || nx >= BALL_HASH_COLS || ny >= BALL_HASH_ROWS) continue;
+                    int nc = ny * BALL_HASH_COLS + nx;
+                    for (int j = h->cell_start[nc]; j < h->cell_start[nc + 1]; j++) 
+                        ball_pair_response(a, &g->balls[h->ids[j]]);
+                }
+            }
+        }
+    }
+}
+
+void update_engine(Game *g, float dt) {
+    if (!g->game_state.is_running || g->game_state.is_paused || g->game_state.show_menu) 
+        return;
+
+    ARK_PROF_BEGIN(PROF_COLLISION);
+    for (int i = 0; i < g->ball_count; i++) step_ball(g, &g->balls[i], dt);
+    if (g->ball_collisions && g->ball_count > 1) collide_balls(g);
+    ARK_PROF_END(PROF_COLLISION);
+
+    for (int i = g->ball_count - 1; i >= 0; i--) {
+        if (g->balls[i].is_held || g->balls[i].rect.y <= WINDOW_HEIGHT) continue;
+        int last = --g->ball_count;
+        g->balls[i] = g->balls[last];
+        g->ball_prev_rect[i] = g->ball_prev_rect[last];
+    }
+
+    if (g->ball_count == 0) {
+        g->game_state.lives--; 
+        sfx_push(g, SFX_LIFE_LOST);
+        if (g->game_state.lives <= 0) {
+            g->game_state.show_menu = 1; 
+            g->game_state.is_running = 0;
+            if (g->backend && g->backend->game_over) g->backend->game_over(g->backend->user, g);
+        } else {
+            g->paddle.rect.x = (WINDOW_WIDTH - g->paddle.rect.w)/2.0f;
+            reset_balls(g);
+            snap_interpolation_state(g);
+        }
+    }
+
+    if (g->game_state.bricks_remaining <= 0) {
+        g->game_state.level++;
+        if (g->game_state.level > MAX_LEVELS) {
+            g->game_state.show_menu = 1; 
+            g->game_state.is_running = 0;
+            if (g->backend && g->backend->game_over) g->backend->game_over(g->backend->user, g);
+        } else {
+            reset_level(g, g->game_state.level);
+        }
+    }
+
+    update_collectibles(g, dt);
+    if (g->headless) return;
+    ARK_PROF_BEGIN(PROF_PARTICLES);
+    update_particles(g, dt); 
+    ARK_PROF_END(PROF_PARTICLES);
+}
+
+/* Everything the player does besides moving the paddle. Returns 0 for a
+   command that does not apply, so callers can log only what took effect. */
+int ark_command(Game *g, GameCommand cmd) {
+    switch (cmd) {
+    case CMD_START:
+        g->game_state.show_menu = 0; 
+        g->game_state.is_running = 1; 
+        reset_level(g, g->game_state.level); 
+        break;
+    case CMD_SPACE:
+        if (g->game_state.is_paused) 
+            g->game_state.is_paused = 0;
+        else if (g->balls[0].is_held) 
+            serve_ball(g);
+        else 
+            g->game_state.is_paused = !g->game_state.is_paused;
+        break;
+    case CMD_PAUSE:
+        if (!g->game_state.is_running || g->game_state.show_menu) return 0;
+        g->game_state.is_paused = !g->game_state.is_paused;
+        break;
+    case CMD_MENU:  g->game_state.show_menu = 1; break;
+    case CMD_RESET: reset_game(g); break;
+    default: return 0;
+    }
+    return 1;
+}
+
+/* One fixed simulation step: paddle motion from velocity_x, then the engine. */
+void ark_tick(Game *g, float dt) {
+    g->paddle.rect.x += g->paddle.velocity_x * dt; 
+    clamp_paddle_position(g); 
+    update_engine(g, dt);
+}
+
+/* Hands each sound raised since the last call to the backend, once. */
+void ark_drain_sfx(Game *g) {
+    uint32_t pending = g->sfx_pending;
+    g->sfx_pending = 0;
+    if (!pending || !g->backend || !g->backend->play_sfx) return;
+    for (int t = 0; t < SFX_COUNT; t++) 
+        if (pending & (1u << t)) g->backend->play_sfx(g->backend->user, (SfxType)t);
+}
+
+/* Frame driver for simple front ends: poll input, run as many fixed ticks of
+   tick_dt as frame_time covers (carrying the remainder over), play sounds and
+   render with the interpolation fraction. Returns the ticks run. */
+int ark_frame(Game *g, double frame_time, double tick_dt) {
+    const ArkBackend *be = g->backend;
+    if (frame_time > SIM_MAX_FRAME_TIME) frame_time = SIM_MAX_FRAME_TIME;
+    g->sim_accumulator += frame_time;
+    if (be && be->poll_input) be->poll_input(be->user, g);
+    int ticks = 0;
+    while (g->sim_accumulator >= tick_dt && ticks < SIM_MAX_TICKS_PER_FRAME) {
+        snap_interpolation_state(g);
+        ark_tick(g, (float)tick_dt);
+        g->sim_accumulator -= tick_dt;
+        ticks++;
+    }
+    if (g->sim_accumulator >= tick_dt) g->sim_accumulator = 0; /* fell too far behind: drop the backlog */
+    ark_drain_sfx(g);
+    if (be && be->render) be->render(be->user, g, (float)(g->sim_accumulator / tick_dt));
+    return ticks;
+}
+
+static void env_start_episode(ArkEnvSlot *s) {
+    reset_game(&s->game);
+    s->game.game_state.show_menu = 0;
+    s->ticks = 0;
+    s->need_reset = 0;
+}
+
+static void env_observe(const ArkEnvs *e, const ArkEnvSlot *s, int score_before, ArkObs *o, uint64_t *bits) {
+    const Game *g = &s->game;
+    const Board *bd = &g->board;
+    o->paddle_x = g->paddle.rect.x;
+    o->paddle_w = g->paddle.rect.w;
+    for (int i = 0; i < ARK_OBS_BALLS; i++) {
+        const Ball *b = &g->balls[i];
+        int live = i < g->ball_count;
+        o->ball[i][0] = live ? b->rect.x : 0.0f;
+        o->ball[i][1] = live ? b->rect.y : 0.0f;
+        o->ball[i][2] = live && !b->is_held ? b->vx * b->speed : 0.0f;
+        o->ball[i][3] = live && !b->is_held ? b->vy * b->speed : 0.0f;
+    }
+    o->ball_count = g->ball_count;
+    o->score = g->game_state.score;
+    o->lives = g->game_state.lives;
+    o->level = g->game_state.level > MAX_LEVELS ? MAX_LEVELS : g->game_state.level;
+    o->bricks_remaining = g->game_state.bricks_remaining;
+    o->reward = (float)(g->game_state.score - score_before);
+    o->rows = (uint16_t)bd->rows;
+    o->cols = (uint16_t)bd->cols;
+    o->done = (uint8_t)!g->game_state.is_running;
+    o->truncated = (uint8_t)(!o->done && e->max_ticks && s->ticks >= e->max_ticks);
+    o->held = (uint8_t)(g->ball_count > 0 && g->balls[0].is_held);
+    o->pad = 0;
+    if (!bits) return;
+    int bit_count = bd->rows * bd->cols;
+    int words = (bit_count + 63) / 64;
+    if (words > e->brick_words) words = e->brick_words;
+    memcpy(bits, bd->alive, (size_t)words * sizeof(uint64_t));
+    if (words * 64 > bit_count) bits[words - 1] &= ~0ull >> (words * 64 - bit_count);
+    memset(bits + words, 0, (size_t)(e->brick_words - words) * sizeof(uint64_t));
+}
+
+static void env_step_chunk(void *ctx, int chunk) {
+    ArkEnvs *e = (ArkEnvs *)ctx;
+    int end = (chunk + 1) * ARK_ENV_CHUNK;
+    if (end > e->num_envs) end = e->num_envs;
+    for (int i = chunk * ARK_ENV_CHUNK; i < end; i++) {
+        ArkEnvSlot *s = &e->slots[i];
+        Game *g = &s->game;
+        if (s->need_reset) env_start_episode(s);
+        int score_before = g->game_state.score;
+        float v = 0.0f;
+        switch (e->actions[i]) {
+        case ARK_ACT_LEFT:  v = -PADDLE_SPEED; break;
+        case ARK_ACT_RIGHT: v = PADDLE_SPEED; break;
+        case ARK_ACT_FIRE:  if (g->balls[0].is_held) serve_ball(g); break;
+        default: break;
+        }
+        g->paddle.velocity_x = v;
+        ark_tick(g, e->dt);
+        g->sfx_pending = 0;
+        s->ticks++;
+        ArkObs *o = &e->obs[i];
+        env_observe(e, s, score_before, o, e->bricks ? e->bricks + (size_t)i * e->brick_words : NULL);
+        s->need_reset = o->done || o->truncated;
+    }
+}
+
+static void env_reset_chunk(void *ctx, int chunk) {
+    ArkEnvs *e = (ArkEnvs *)ctx;
+    int end = (chunk + 1) * ARK_ENV_CHUNK;
+    if (end > e->num_envs) end = e->num_envs;
+    for (int i = chunk * ARK_ENV_CHUNK; i < end; i++) {
+        ArkEnvSlot *s = &e->slots[i];
+        env_start_episode(s);
+        env_observe(e, s, s->game.game_state.score, &e->obs[i], 
+                    e->bricks ? e->bricks + (size_t)i * e->brick_words : NULL);
+    }
+}
+
+static void env_run(ArkEnvs *e, void (*job)(void *ctx, int index)) {
+    int chunks = (e->num_envs + ARK_ENV_CHUNK - 1) / ARK_ENV_CHUNK;
+    if (e->runner && e->runner->parallel_for && chunks > 1) {
+        e->runner->parallel_for(e->runner->user, chunks, job, e);
+    } else {
+        for (int c = 0; c < chunks; c++) job(e, c);
+    }
+}
+
+ArkEnvs *ark_envs_create(const ArkEnvConfig *cfg) {
+    if (cfg->num_envs < 1) return NULL;
+    ArkEnvs *e = (ArkEnvs *)calloc(1, sizeof(ArkEnvs));
+    if (!e) return NULL;
+    e->slots = (ArkEnvSlot *)malloc((size_t)cfg->num_envs * sizeof(ArkEnvSlot));
+    if (!e->slots) { 
+        free(e); 
+        return NULL; 
+    }
+    int hz = cfg->tick_hz > 0 ? cfg->tick_hz : SIM_TICK_HZ;
+    e->num_envs = cfg->num_envs;
+    e->brick_words = cfg->brick_words > 0 ? cfg->brick_words : (BRICK_ROWS * BRICK_COLUMNS + 63) / 64;
+    e->dt = 1.0f / (float)hz;
+    e->max_ticks = cfg->max_ticks;
+    e->runner = cfg->runner;
+    for (int i = 0; i < e->num_envs; i++) {
+        ArkEnvSlot *s = &e->slots[i];
+        init_game(&s->game, cfg->backend, cfg->seed + (uint32_t)i * 2654435761u, 1);
+        s->game.ball_collisions = cfg->ball_collisions;
+        s->ticks = 0;
+        s->need_reset = 1;
+    }
+    return e;
+}
+
+void ark_envs_free(ArkEnvs *e) {
+    if (!e) return;
+    free(e->slots);
+    free(e);
+}
+
+void ark_envs_reset(ArkEnvs *e, ArkObs *obs, uint64_t *bricks) {
+    e->obs = obs;
+    e->bricks = bricks;
+    env_run(e, env_reset_chunk);
+}
+
+void ark_envs_step(ArkEnvs *e, const uint8_t *actions, ArkObs *obs, uint64_t *bricks) {
+    e->actions = actions;
+    e->obs = obs;
+    e->bricks = bricks;
+    env_run(e, env_step_chunk);
+}
+
+#endif /* ARK_CORE_IMPLEMENTATION */
+#endif /* ARKANOID_CORE_H */
@@ -5,12 +5,13 @@
    COMPONENT 1: GAME ENGINE & LOGIC CORE (Member 1 & 2)
    - Ball movement logic, paddle control, brick collisions
    - Score update mechanism, game state management
-   - Functions: update_engine(), reset_game(), reset_level()
+   - Lives in arkanoid_core.h, shared with the Win32 build (arkanoid.c)
+   - Functions: update_engine(), reset_game(), reset_level(), ark_command()
    
    COMPONENT 2: GRAPHICS & RENDERING (Member 3 & 4)
    - Frame buffer drawing, rendering bricks/ball/paddle
    - Visual effects (particles, glow, background)
-   - Functions: render_scene(), draw_*() functions, spawn_stars()
+   - Functions: render_scene(), draw_*() functions
    
    COMPONENT 3: INPUT HANDLING (Member 5 & 6)
    - Keyboard/mouse input for paddle movement and game control
@@ -20,12 +21,28 @@
    COMPONENT 4: LEVELS, SCORING & PROGRESSION (Member 7 & 8)
    - Level design from files, score/lives tracking
    - Difficulty progression, leaderboard management
-   - Functions: load_level_from_file(), load/save_highscore(), leaderboard functions
+   - Functions: sdl_level_cells(), load/save_highscore(), leaderboard functions
    
    COMPONENT 5: SOUND, UI & MENU SYSTEM (Member 9 & 10)
    - Start menu, pause, game-over screens
    - Background music and sound effects
-   - Functions: draw_text_pixel(), menu rendering in render_scene(), load_audio_assets()
+   - Functions: draw_text_pixel(), menu rendering in render_scene(), assets_start()
+   
+   Compile: gcc arkanoid_full.c -o arkanoid $(sdl2-config --cflags --libs) -lSDL2_mixer -lm
+            (add -lws2_32 on Windows)
+            (arkanoid_core.h must sit next to this file)
+   Run:     ./arkanoid [--tick-rate HZ] [--pace vsync|uncapped|cap|powersave] [--fps N] [--no-late-latch]
+                       [--quality 0..3]   (pin a tier, see QUALITY GOVERNOR)
+                       [--player ABC] [--ball-collisions] [--seed N] [--record FILE]
+                       [--threaded]   (sim on its own thread, see THREADED MODE)
+                       [--spectate udp:HOST:PORT|FILE|-]   (state stream, see SPECTATOR STREAM)
+            ./arkanoid --headless [...]   (bot batch simulation, see HEADLESS section)
+            ./arkanoid --env-bench [--envs N] [--steps N]   (step/observe API, see TRAINING ENVIRONMENTS)
+            ./arkanoid --replay FILE [--render-every N]   (see REPLAY sections)
+            ./arkanoid --spectate-view udp:[HOST]:PORT|FILE|-   (mirror a --spectate TARGET stream)
+            ./arkanoid --bench [--bench-samples N] [--csv FILE]   (see BENCHMARKS)
+            ./arkanoid --compile-levels [levels.pak]   (levelN.txt -> binary pack)
+   Profile: F3 overlay, F4 trace/CSV export; -DNDEBUG compiles it out
    
    ===================================================================== */
 
@@ -35,47 +52,215 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <float.h>
+#include <ctype.h>
+#include <limits.h>
 #include <time.h>
+#ifdef _WIN32
+#include <winsock2.h>       /* before windows.h */
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+typedef SOCKET SpecSocket;
+#define SPEC_NO_SOCKET INVALID_SOCKET
+#define spec_closesocket closesocket
+#else
+#include <fcntl.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <unistd.h>
+typedef int SpecSocket;
+#define SPEC_NO_SOCKET (-1)
+#define spec_closesocket close
+#endif
 
 /* --------------------- CONFIG --------------------- */
-#define WINDOW_WIDTH 960
-#define WINDOW_HEIGHT 640
+/* Geometry and tuning live in arkanoid_core.h; these are front-end only. */
+#define BG_REFRESH_HZ 10
+#define BG_BANDS 80             /* nebula bands at full quality */
+#define NUM_STARS 2400          /* background stars, spread over STAR_LAYERS */
+#define STAR_LAYERS 3
+#define STAR_DRIFT 6.0f         /* px/s of the farthest layer; each nearer one adds as much */
+#define STAR_SEED 0x5EED57A2u
+#define LEADERBOARD_N 5
+#define SFX_QUEUE_SIZE 64
+#define SFX_MIN_GAP_MS 30
 
-#define PADDLE_WIDTH 140
-#define PADDLE_HEIGHT 18
-#define PADDLE_Y_OFFSET 64
-#define PADDLE_SPEED 800.0f
 
-#define BALL_SIZE 14
-#define BALL_SPEED_INITIAL 420.0f
-#define BALL_SPEED_GROWTH 1.0f
+/* ========================================================================
+   FRAME PROFILER
+   Scoped timers per frame phase and subsystem, published frame by frame
+   into a ring that readers (overlay, export) snapshot without locking.
+   Build with -DNDEBUG or -DARK_PROFILE=0 and every PROF_* macro compiles
+   to nothing. F3 toggles the overlay, F4 writes arkanoid_trace.json
+   (chrome://tracing / Perfetto) and arkanoid_frames.csv.
+   ======================================================================== */
+#ifndef ARK_PROFILE
+#ifdef NDEBUG
+#define ARK_PROFILE 0
+#else
+#define ARK_PROFILE 1
+#endif
+#endif
 
-#define BRICK_COLUMNS 12
-#define BRICK_ROWS 7
-#define BRICK_WIDTH (WINDOW_WIDTH / BRICK_COLUMNS)
-#define BRICK_HEIGHT 28
-#define BRICK_PADDING 4
+typedef enum {
+    /* top-level frame phases */
+    PROF_INPUT, PROF_SIM, PROF_RENDER, PROF_PRESENT, PROF_SLEEP,
+    /* subsystems nested in the phases above */
+    PROF_COLLISION, PROF_PARTICLES, 
+    PROF_BACKGROUND, PROF_BRICKS, PROF_PARTICLES_DRAW, PROF_HUD, PROF_SUBMIT,
+    PROF_COUNT
+} ProfPhase;
 
-#define MAX_LEVELS 10
-#define STARTING_LIVES 3
+#define PROF_FIRST_SUB PROF_COLLISION
+#define PROF_RING 240
 
-#define NUM_STARS 220
-#define STAR_LAYERS 3
+#if ARK_PROFILE
+static const char *PROF_NAMES[PROF_COUNT] = {
+    "INPUT", "SIM", "RENDER", "PRESENT", "SLEEP",
+    "COLLISION", "PARTICLES", 
+    "BACKGROUND", "BRICKS", "FX_DRAW", "HUD", "SUBMIT"
+};
 
-#define MAX_PARTICLES 512
-#define MAX_COLLECTIBLES 8
+/* Times are ns since profiler start. A phase entered several times per
+   frame (one per sim tick) keeps its first start and the summed time. */
+typedef struct {
+    Uint64 start_ns, frame_ns;
+    Uint64 phase_start[PROF_COUNT];
+    Uint64 phase_ns[PROF_COUNT];
+    int draw_calls, quads, particles, collectibles, sim_ticks;
+} ProfFrame;
 
-#define LEADERBOARD_N 5
+typedef struct {
+    ProfFrame ring[PROF_RING];
+    SDL_atomic_t published;     /* frames completed; slot = n % PROF_RING */
+    ProfFrame cur;
+    Uint64 open[PROF_COUNT];
+    Uint64 origin;
+    double ns_per_count;
+    int active;                 /* only the interactive loop profiles */
+    int show_overlay;
+} Profiler;
+
+Profiler prof;
+
+static inline Uint64 prof_now(void) {
+    return (Uint64)((double)(SDL_GetPerformanceCounter() - prof.origin) * prof.ns_per_count);
+}
+
+void prof_init(void) {
+    memset(&prof, 0, sizeof(prof));
+    prof.origin = SDL_GetPerformanceCounter();
+    prof.ns_per_count = 1e9 / (double)SDL_GetPerformanceFrequency();
+    prof.active = 1;
+}
+
+void prof_begin(ProfPhase p) {
+    if (!prof.active) return;
+    prof.open[p] = prof_now();
+    if (prof.cur.phase_ns[p] == 0) prof.cur.phase_start[p] = prof.open[p];
+}
+
+void prof_end(ProfPhase p) {
+    if (!prof.active) return;
+    prof.cur.phase_ns[p] += prof_now() - prof.open[p];
+}
+
+void prof_frame_begin(void) {
+    if (!prof.active) return;
+    memset(&prof.cur, 0, sizeof(prof.cur));
+    prof.cur.start_ns = prof_now();
+}
+
+void prof_frame_end(int draw_calls, int quads, int particles, int collectibles, int sim_ticks) {
+    if (!prof.active) return;
+    ProfFrame *f = &prof.cur;
+    f->frame_ns = prof_now() - f->start_ns;
+    f->draw_calls = draw_calls; 
+    f->quads = quads;
+    f->particles = particles; 
+    f->collectibles = collectibles; 
+    f->sim_ticks = sim_ticks;
+    int n = SDL_AtomicGet(&prof.published);
+    prof.ring[n % PROF_RING] = *f;
+    SDL_AtomicSet(&prof.published, n + 1);   /* full barrier: slot is visible first */
+}
+
+/* Copies up to max of the newest frames, oldest first. A slot the writer
+   may have lapped during the copy is dropped. */
+int prof_snapshot(ProfFrame *out, int max) {
+    int end = SDL_AtomicGet(&prof.published);
+    if (max > PROF_RING - 1) max = PROF_RING - 1;
+    int begin = end - max;
+    if (begin < 0) begin = 0;
+    for (int i = begin; i < end; i++) out[i - begin] = prof.ring[i % PROF_RING];
+    int lapped = SDL_AtomicGet(&prof.published) - (PROF_RING - 1) - begin;
+    if (lapped <= 0) return end - begin;
+    if (lapped >= end - begin) return 0;
+    memmove(out, out + lapped, sizeof(ProfFrame) * (size_t)(end - begin - lapped));
+    return end - begin - lapped;
+}
+
+int prof_export(const char *trace_path, const char *csv_path) {
+    static ProfFrame frames[PROF_RING];
+    int n = prof_snapshot(frames, PROF_RING);
+    FILE *f = fopen(trace_path, "w");
+    if (!f) return 0;
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (int i = 0; i < n; i++) {
+        ProfFrame *fr = &frames[i];
+        fprintf(f, "{\"name\":\"FRAME\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f},\n", 
+                fr->start_ns / 1000.0, fr->frame_ns / 1000.0);
+        for (int p = 0; p < PROF_COUNT; p++) {
+            if (!fr->phase_ns[p]) continue;
+            /* subsystems on their own track: summed spans need not nest */
+            fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n", 
+                    PROF_NAMES[p], p < PROF_FIRST_SUB ? 1 : 2, 
+                    fr->phase_start[p] / 1000.0, fr->phase_ns[p] / 1000.0);
+        }
+        fprintf(f, "{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":"
+                   "{\"draw_calls\":%d,\"quads\":%d,\"particles\":%d,\"collectibles\":%d,\"sim_ticks\":%d}}%s\n", 
+                fr->start_ns / 1000.0, fr->draw_calls, fr->quads, fr->particles, 
+                fr->collectibles, fr->sim_ticks, i + 1 < n ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+
+    f = fopen(csv_path, "w");
+    if (!f) return 0;
+    fprintf(f, "frame_us");
+    for (int p = 0; p < PROF_COUNT; p++) fprintf(f, ",%s_us", PROF_NAMES[p]);
+    fprintf(f, ",draw_calls,quads,particles,collectibles,sim_ticks\n");
+    for (int i = 0; i < n; i++) {
+        ProfFrame *fr = &frames[i];
+        fprintf(f, "%.1f", fr->frame_ns / 1000.0);
+        for (int p = 0; p < PROF_COUNT; p++) fprintf(f, ",%.1f", fr->phase_ns[p] / 1000.0);
+        fprintf(f, ",%d,%d,%d,%d,%d\n", fr->draw_calls, fr->quads, fr->particles, 
+                fr->collectibles, fr->sim_ticks);
+    }
+    fclose(f);
+    return n;
+}
+
+#define PROF_BEGIN(p) prof_begin(p)
+#define PROF_END(p) prof_end(p)
+#else
+#define PROF_BEGIN(p) ((void)0)
+#define PROF_END(p) ((void)0)
+#endif
 
-/* --------------------- TYPES --------------------- */
-typedef struct { float x, y, w, h; } RectF;
-typedef struct { RectF rect; int is_alive; int color_index; int special; } Brick;
-typedef struct { RectF rect; float velocity_x; } Paddle;
-typedef struct { RectF rect; float vx, vy; float speed; int is_held; } Ball;
-typedef struct { int score; int lives; int level; int bricks_remaining; int is_paused; int is_running; int show_menu; } GameState;
-typedef struct { float x, y; float size; int layer; float vx, vy; } Star;
-typedef struct { float x, y; float vx, vy; float life; float max_life; SDL_Color col; int alive; } Particle;
-typedef struct { RectF rect; float vx, vy; int alive; int type; } Collectible;
+/* --------------------- CORE --------------------- */
+/* Simulation shared with the Win32 build; engine phases feed the profiler. */
+#define ARK_PROF_BEGIN(p) PROF_BEGIN(p)
+#define ARK_PROF_END(p) PROF_END(p)
+#define ARK_CORE_IMPLEMENTATION
+#include "arkanoid_core.h"
 
 /* --------------------- GLOBALS --------------------- */
 SDL_Window *window = NULL;
@@ -84,839 +269,4524 @@ Mix_Chunk *sfx_bounce = NULL;
 Mix_Chunk *sfx_break = NULL;
 Mix_Music *music_bgm = NULL;
 
-Paddle paddle;
-Ball ball;
-Brick bricks[BRICK_ROWS * BRICK_COLUMNS];
+Game game;
 SDL_Color color_palette[10];
-GameState game_state;
-Star stars[NUM_STARS];
-Particle particles[MAX_PARTICLES];
-Collectible collectibles[MAX_COLLECTIBLES];
 
 RectF menu_play_rect;
-int high_score = 0;
-int leaderboard[LEADERBOARD_N];
+int assets_ready = 0;   /* set once the async loader has published (see ASSET LOADER) */
 const char *HIGH_SCORE_FILE = "highscore.dat";
-const char *LEADERBOARD_FILE = "leaderboard.dat";
+const char *LEADERBOARD_FILE = "leaderboard.dat";   /* legacy top-5, imported once */
+const char *SCORES_LOG_FILE = "scores.log";
+const char *SCORES_SNAPSHOT_FILE = "scores.snap";
+
+int sim_tick_hz = SIM_TICK_HZ;
+int ball_collisions = 0;   /* --ball-collisions: balls bounce off each other */
 
 /* ========================================================================
-   START: COMPONENT 1 - GAME ENGINE & LOGIC CORE (Member 1 & 2)
+   FRAME PACING
+   Decides how each frame waits after SDL_RenderPresent:
+     vsync      present blocks on the display; no extra sleep
+     uncapped   no waiting at all
+     cap        fixed rate: coarse SDL_Delay, then spin the last stretch
+     powersave  vsync while playing, PACE_IDLE_HZ while in menu or paused
+   A frame that lands more than PACE_MISS_SLACK past its deadline (for
+   vsync: a present interval over 1.5 refreshes) counts as missed.
    ======================================================================== */
-static inline int brick_index(int row, int col) { 
-    return row * BRICK_COLUMNS + col; 
+#define PACE_DEFAULT_FPS 60
+#define PACE_IDLE_HZ 20
+#define PACE_SPIN_MS 2.0
+#define PACE_MISS_SLACK 0.0005
+
+typedef enum { PACE_VSYNC, PACE_UNCAPPED, PACE_CAP, PACE_POWERSAVE } PaceMode;
+
+static const char *PACE_NAMES[] = { "vsync", "uncapped", "cap", "powersave" };
+
+typedef struct {
+    PaceMode mode;
+    int cap_fps;
+    double refresh_period;      /* display refresh, for vsync miss detection */
+    double freq;
+    Uint64 deadline;            /* next frame's target counter value */
+    Uint64 last_present;
+    Uint64 frames, missed;
+    double worst_late;          /* seconds */
+} FramePacer;
+
+FramePacer pacer = { .mode = PACE_VSYNC, .cap_fps = PACE_DEFAULT_FPS };
+
+int pace_mode_from_name(const char *name) {
+    for (int i = 0; i < (int)(sizeof(PACE_NAMES) / sizeof(PACE_NAMES[0])); i++) 
+        if (strcmp(name, PACE_NAMES[i]) == 0) return i;
+    return -1;
 }
 
-void clamp_paddle_position() { 
-    if (paddle.rect.x < 0) paddle.rect.x = 0; 
-    if (paddle.rect.x + paddle.rect.w > WINDOW_WIDTH) 
-        paddle.rect.x = WINDOW_WIDTH - paddle.rect.w; 
+int pacer_wants_vsync(const FramePacer *p) {
+    return p->mode == PACE_VSYNC || p->mode == PACE_POWERSAVE;
 }
 
-int rect_overlap(RectF *a, RectF *b) { 
-    return !(a->x + a->w <= b->x || b->x + b->w <= a->x || 
-             a->y + a->h <= b->y || b->y + b->h <= a->y); 
+void pacer_init(FramePacer *p, SDL_Window *win) {
+    SDL_DisplayMode dm;
+    p->freq = (double)SDL_GetPerformanceFrequency();
+    p->refresh_period = 1.0 / 60.0;
+    if (win && SDL_GetWindowDisplayMode(win, &dm) == 0 && dm.refresh_rate > 0) 
+        p->refresh_period = 1.0 / dm.refresh_rate;
+    if (p->cap_fps <= 0) p->cap_fps = PACE_DEFAULT_FPS;
+    p->last_present = p->deadline = SDL_GetPerformanceCounter();
+    p->frames = p->missed = 0;
+    p->worst_late = 0;
 }
-/* ======================================================================== 
-   END: COMPONENT 1 - GAME ENGINE & LOGIC CORE
-   ======================================================================== */
 
-/* ========================================================================
-   START: COMPONENT 4 - LEVELS, SCORING & PROGRESSION (Member 7 & 8)
-   ======================================================================== */
-static void load_highscore(void) {
-    FILE *f = fopen(HIGH_SCORE_FILE, "rb");
-    if (!f) { high_score = 0; return; }
-    int sc = 0;
-    if (fread(&sc, sizeof(int), 1, f) == 1) high_score = sc;
-    else high_score = 0;
-    fclose(f);
+static void pacer_note_late(FramePacer *p, double late) {
+    if (late <= PACE_MISS_SLACK) return;
+    p->missed++;
+    if (late > p->worst_late) p->worst_late = late;
 }
 
-static void save_highscore(void) {
-    FILE *f = fopen(HIGH_SCORE_FILE, "wb");
-    if (!f) return;
-    fwrite(&high_score, sizeof(int), 1, f);
-    fclose(f);
+/* Sleep until the counter reaches target: SDL_Delay for whole milliseconds
+   while more than PACE_SPIN_MS remain, then spin for precision. */
+static void pacer_sleep_until(FramePacer *p, Uint64 target) {
+    for (;;) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now >= target) return;
+        double left_ms = (double)(target - now) * 1000.0 / p->freq;
+        if (left_ms > PACE_SPIN_MS) SDL_Delay((Uint32)(left_ms - PACE_SPIN_MS));
+        else if (left_ms > 0.2) SDL_Delay(0);
+    }
 }
 
-static void load_leaderboard(void) {
-    FILE *f = fopen(LEADERBOARD_FILE, "rb");
-    if (!f) { for (int i=0;i<LEADERBOARD_N;i++) leaderboard[i]=0; return; }
-    size_t r = fread(leaderboard, sizeof(int), LEADERBOARD_N, f);
-    if (r < (size_t)LEADERBOARD_N) for (int i=r;i<LEADERBOARD_N;i++) leaderboard[i]=0;
-    fclose(f);
+/* Called once per frame, right after SDL_RenderPresent. */
+void pacer_wait(FramePacer *p, int idle) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    p->frames++;
+    int throttle = p->mode == PACE_CAP || (p->mode == PACE_POWERSAVE && idle);
+    if (!throttle) {
+        if (pacer_wants_vsync(p) && p->frames > 1) 
+            pacer_note_late(p, (double)(now - p->last_present) / p->freq - 1.5 * p->refresh_period + PACE_MISS_SLACK);
+        p->last_present = p->deadline = now;
+        return;
+    }
+    int hz = p->mode == PACE_CAP ? p->cap_fps : PACE_IDLE_HZ;
+    Uint64 period = (Uint64)(p->freq / hz);
+    p->deadline += period;
+    if (now > p->deadline) {
+        /* missed: resync instead of bursting frames to catch up */
+        pacer_note_late(p, (double)(now - p->deadline) / p->freq);
+        p->deadline = now;
+    } else {
+        pacer_sleep_until(p, p->deadline);
+    }
+    p->last_present = SDL_GetPerformanceCounter();
 }
 
-static void save_leaderboard(void) {
-    FILE *f = fopen(LEADERBOARD_FILE, "wb");
-    if (!f) return;
-    fwrite(leaderboard, sizeof(int), LEADERBOARD_N, f);
-    fclose(f);
+void pacer_report(const FramePacer *p) {
+    if (p->mode == PACE_CAP) 
+        fprintf(stderr, "pacer: %s %d Hz, ", PACE_NAMES[p->mode], p->cap_fps);
+    else 
+        fprintf(stderr, "pacer: %s, ", PACE_NAMES[p->mode]);
+    fprintf(stderr, "%llu frames, %llu missed (%.2f%%), worst %.2f ms late\n", 
+            (unsigned long long)p->frames, (unsigned long long)p->missed, 
+            p->frames ? 100.0 * (double)p->missed / (double)p->frames : 0.0, p->worst_late * 1000.0);
 }
 
-static void add_to_leaderboard(int score) {
-    if (score <= 0) return;
-    int tmp[LEADERBOARD_N+1];
-    int i,j,k=0;
-    for (i=0;i<LEADERBOARD_N;i++) tmp[i]=leaderboard[i];
-    tmp[LEADERBOARD_N]=score;
-    for (i=0;i<LEADERBOARD_N+1;i++) {
-        for (j=i+1;j<LEADERBOARD_N+1;j++) 
-            if (tmp[j] > tmp[i]) { 
-                int t=tmp[i]; tmp[i]=tmp[j]; tmp[j]=t; 
-            }
-    }
-    for (i=0;i<LEADERBOARD_N;i++) leaderboard[i]=tmp[i];
-    save_leaderboard();
+/* ========================================================================
+   QUALITY GOVERNOR
+   Sheds cosmetic load when frames run over budget. Each tier scales the
+   particle bursts, the ball's glow rings, the nebula bands and the stars.
+   The budget is one display refresh, or 1/cap_fps when capped. A frame is
+   over when it missed that budget or spent more than QUALITY_OVER of it
+   before SDL_RenderPresent, and under when it made it with work below
+   QUALITY_UNDER. QUALITY_DOWN_FRAMES overs in a row drop a tier,
+   up_frames unders in a row restore one. A drop soon after a rise doubles
+   up_frames (up to QUALITY_UP_MAX), so a load sitting right at the edge
+   settles on a tier instead of flipping between two.
+   ======================================================================== */
+#define QUALITY_OVER 0.9
+#define QUALITY_UNDER 0.5
+#define QUALITY_MISS 1.25           /* frame interval, in budgets, that counts as missed */
+#define QUALITY_DOWN_FRAMES 4
+#define QUALITY_UP_FRAMES 120
+#define QUALITY_UP_MAX (QUALITY_UP_FRAMES * 8)
+
+typedef struct { int particle_pct, glow_rings, bands, stars; } QualityTier;
+
+static const QualityTier QUALITY_TIERS[] = {
+    { 100, 6, BG_BANDS,     NUM_STARS },
+    {  50, 4, BG_BANDS / 2, NUM_STARS / 2 },
+    {  25, 2, BG_BANDS / 4, NUM_STARS / 4 },
+    {  10, 0, BG_BANDS / 8, NUM_STARS / 8 },
+};
+#define QUALITY_TIER_COUNT ((int)(sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0])))
+
+typedef struct {
+    SDL_atomic_t tier;          /* 0 = full; the sim thread reads it in threaded mode */
+    int pinned;                 /* --quality N: governor off */
+    int over_run, under_run;
+    int up_frames;
+    Uint64 frames, raised_at;
+    Uint64 drops, raises;
+    double work_ms;             /* last frame, for the overlay */
+} QualityGovernor;
+
+QualityGovernor quality = { .up_frames = QUALITY_UP_FRAMES };
+
+static inline const QualityTier *quality_tier(void) { 
+    return &QUALITY_TIERS[SDL_AtomicGet(&quality.tier)]; 
 }
 
-int load_level_from_file(int level) {
-    char name[128]; 
-    snprintf(name, sizeof(name), "level%d.txt", level);
-    FILE *f = fopen(name, "r");
-    if (!f) return 0;
-    char line[256];
-    for (int r = 0; r < BRICK_ROWS; r++) {
-        if (!fgets(line, sizeof(line), f)) {
-            for (int c = 0; c < BRICK_COLUMNS; c++) {
-                Brick *b = &bricks[brick_index(r,c)];
-                b->rect.w = BRICK_WIDTH - BRICK_PADDING; 
-                b->rect.h = BRICK_HEIGHT - BRICK_PADDING;
-                b->rect.x = c * BRICK_WIDTH + BRICK_PADDING/2; 
-                b->rect.y = 80 + r * (BRICK_HEIGHT + BRICK_PADDING);
-                b->is_alive = 0; b->special = 0; 
-                b->color_index = (r + c + level) % 10;
-            }
-            continue;
-        }
-        for (int c = 0; c < BRICK_COLUMNS; c++) {
-            Brick *b = &bricks[brick_index(r,c)];
-            b->rect.w = BRICK_WIDTH - BRICK_PADDING; 
-            b->rect.h = BRICK_HEIGHT - BRICK_PADDING;
-            b->rect.x = c * BRICK_WIDTH + BRICK_PADDING/2; 
-            b->rect.y = 80 + r * (BRICK_HEIGHT + BRICK_PADDING);
-            char ch = (c < (int)strlen(line)) ? line[c] : '.';
-            if (ch == '#') { b->is_alive = 1; b->special = 0; }
-            else if (ch == 'A') { b->is_alive = 1; b->special = 1; }
-            else { b->is_alive = 0; b->special = 0; }
-            b->color_index = (r + c + level) % 10;
-        }
-    }
-    fclose(f);
-    int alive = 0; 
-    for (int i=0;i<BRICK_ROWS*BRICK_COLUMNS;i++) 
-        if (bricks[i].is_alive) alive++;
-    game_state.bricks_remaining = alive;
-    return 1;
+void quality_pin(int tier) {
+    if (tier < 0) tier = 0;
+    if (tier >= QUALITY_TIER_COUNT) tier = QUALITY_TIER_COUNT - 1;
+    SDL_AtomicSet(&quality.tier, tier);
+    quality.pinned = 1;
 }
 
-void reset_level(int level) {
-    if (load_level_from_file(level)) {
-        // loaded from file
+/* Called once per frame after pacer_wait. interval: seconds since the
+   previous frame started; work: seconds this one spent before present.
+   Throttled idle frames (powersave in the menu) say nothing about load. */
+void quality_note_frame(double interval, double work, int idle) {
+    quality.work_ms = work * 1000.0;
+    if (quality.pinned || (idle && pacer.mode == PACE_POWERSAVE)) return;
+    quality.frames++;
+    double budget = pacer.mode == PACE_CAP ? 1.0 / pacer.cap_fps : pacer.refresh_period;
+    int tier = SDL_AtomicGet(&quality.tier);
+    if (interval > QUALITY_MISS * budget || work > QUALITY_OVER * budget) {
+        quality.under_run = 0;
+        if (++quality.over_run < QUALITY_DOWN_FRAMES || tier == QUALITY_TIER_COUNT - 1) return;
+        if (quality.raised_at && quality.frames - quality.raised_at < (Uint64)quality.up_frames) 
+            quality.up_frames = quality.up_frames * 2 > QUALITY_UP_MAX ? QUALITY_UP_MAX : quality.up_frames * 2;
+        SDL_AtomicSet(&quality.tier, tier + 1);
+        quality.over_run = 0;
+        quality.drops++;
+    } else if (work < QUALITY_UNDER * budget) {
+        quality.over_run = 0;
+        if (++quality.under_run < quality.up_frames || tier == 0) return;
+        SDL_AtomicSet(&quality.tier, tier - 1);
+        quality.under_run = 0;
+        quality.raised_at = quality.frames;
+        quality.raises++;
     } else {
-        int alive_count = 0;
-        for (int r = 0; r < BRICK_ROWS; r++) {
-            for (int c = 0; c < BRICK_COLUMNS; c++) {
-                Brick *b = &bricks[brick_index(r,c)];
-                b->rect.w = BRICK_WIDTH - BRICK_PADDING; 
-                b->rect.h = BRICK_HEIGHT - BRICK_PADDING;
-                b->rect.x = c * BRICK_WIDTH + BRICK_PADDING/2; 
-                b->rect.y = 80 + r * (BRICK_HEIGHT + BRICK_PADDING);
-                if ((level <= 1) || ((r + c + level) % (1 + level / 2) != 0)) {
-                    b->is_alive = 1; alive_count++; 
-                    b->special = (rand()%18==0) ? 1 : 0;
-                } else { 
-                    b->is_alive = 0; b->special = 0; 
-                }
-                b->color_index = (r + c + level) % 10;
-            }
-        }
-        game_state.bricks_remaining = alive_count;
+        quality.over_run = quality.under_run = 0;
     }
-    paddle.rect.x = (WINDOW_WIDTH - paddle.rect.w) / 2.0f; 
-    paddle.rect.y = WINDOW_HEIGHT - PADDLE_Y_OFFSET;
-    ball.rect.x = paddle.rect.x + (paddle.rect.w - ball.rect.w) / 2.0f; 
-    ball.rect.y = paddle.rect.y - ball.rect.h - 2; 
-    ball.vx = 0; ball.vy = -1; 
-    ball.speed = BALL_SPEED_INITIAL; 
-    ball.is_held = 1;
-    for (int ci=0; ci<MAX_COLLECTIBLES; ci++) 
-        collectibles[ci].alive = 0;
 }
 
-void reset_game() { 
-    game_state.score = 0; 
-    game_state.lives = STARTING_LIVES; 
-    game_state.level = 1; 
-    game_state.is_paused = 0; 
-    game_state.is_running = 1; 
-    game_state.show_menu = 1; 
-    reset_level(game_state.level); 
+void quality_report(void) {
+    if (quality.pinned) 
+        fprintf(stderr, "quality: pinned at tier %d\n", SDL_AtomicGet(&quality.tier));
+    else 
+        fprintf(stderr, "quality: tier %d, %llu drops, %llu raises\n", SDL_AtomicGet(&quality.tier), 
+                (unsigned long long)quality.drops, (unsigned long long)quality.raises);
 }
-/* ======================================================================== 
-   END: COMPONENT 4 - LEVELS, SCORING & PROGRESSION
-   ======================================================================== */
 
 /* ========================================================================
-   START: COMPONENT 2 - GRAPHICS & RENDERING (Member 3 & 4)
+   REPLAY LOG
+   A replay is the seed plus what the player did on each fixed sim tick:
+   the paddle position the tick started from and any game commands
+   (start, space, menu, reset) raised since the previous tick. Gameplay
+   draws only from Game.rng and cosmetics from Game.fx_rng, so rerunning
+   the ticks from the same seed reproduces the game exactly.
+   File layout (little endian):
+     header  "ARKR", version, flags, tick rate (u16), seed (u32)
+     ticks   LEB128 varints per tick: zigzag(paddle dx) << 1 | has_cmds,
+             then, if has_cmds, a command count and one byte per command.
+             A zero token starts an idle run: varint count of ticks with
+             no motion and no commands. A zero-length run ends the stream.
+     footer  varints: ticks, score, level, lives (checked on playback)
+   While recording, the paddle is snapped to 1/REPLAY_SUBPIXEL px before
+   each tick so the logged position is exactly the simulated one.
    ======================================================================== */
-void spawn_particles(float x, float y, SDL_Color col, int count) {
-    for (int i = 0; i < MAX_PARTICLES && count > 0; i++) {
-        if (!particles[i].alive) {
-            particles[i].alive = 1; 
-            particles[i].x = x; 
-            particles[i].y = y;
-            float ang = ((rand()%360) * (M_PI/180.0f));
-            float sp = 60 + (rand()%120);
-            particles[i].vx = cosf(ang)*sp; 
-            particles[i].vy = sinf(ang)*sp;
-            particles[i].life = 0.0f; 
-            particles[i].max_life = 0.5f + ((rand()%100)/200.0f);
-            particles[i].col = col; 
-            count--;
-        }
-    }
-}
-
-void update_particles(float dt) {
-    for (int i=0;i<MAX_PARTICLES;i++) {
-        if (!particles[i].alive) continue;
-        particles[i].x += particles[i].vx * dt; 
-        particles[i].y += particles[i].vy * dt; 
-        particles[i].vy += 200.0f * dt;
-        particles[i].life += dt; 
-        if (particles[i].life >= particles[i].max_life) 
-            particles[i].alive = 0;
-    }
-}
-
-void update_collectibles(float dt) {
-    for (int i=0;i<MAX_COLLECTIBLES;i++) {
-        if (!collectibles[i].alive) continue;
-        collectibles[i].rect.x += collectibles[i].vx * dt;
-        collectibles[i].rect.y += collectibles[i].vy * dt;
-        if (collectibles[i].rect.y > WINDOW_HEIGHT) 
-            collectibles[i].alive = 0;
-        RectF pr = collectibles[i].rect;
-        if (rect_overlap(&pr, &paddle.rect)) {
-            if (collectibles[i].type == 0) {
-                paddle.rect.w += 40; 
-                if (paddle.rect.w > WINDOW_WIDTH/2) 
-                    paddle.rect.w = WINDOW_WIDTH/2; 
-                clamp_paddle_position();
-            }
-            collectibles[i].alive = 0;
-        }
+#define REPLAY_VERSION 1
+#define REPLAY_SUBPIXEL 16.0f
+#define REPLAY_MAX_CMDS 16
+#define REPLAY_FLAG_BALL_COLLISIONS 1u
+
+typedef enum { REPLAY_OFF, REPLAY_RECORD, REPLAY_PLAY } ReplayMode;
+
+typedef struct {
+    ReplayMode mode;
+    FILE *out;
+    const Uint8 *data;          /* playback: whole file */
+    size_t size, pos;
+    Uint8 cmds[REPLAY_MAX_CMDS];
+    int cmd_count;              /* commands raised since the last tick */
+    Uint64 idle_run;
+    Sint32 last_x;              /* paddle x in subpixels at the last tick */
+    Uint64 ticks;
+    Uint32 seed;
+    int tick_hz;
+    Uint32 flags;
+    int ended;
+    int score, level, lives;    /* recording: state after the last tick */
+} Replay;
+
+Replay replay;
+
+static void put_varint(FILE *f, Uint64 v) {
+    Uint8 buf[10];
+    int n = 0;
+    do {
+        buf[n] = (Uint8)(v & 0x7F);
+        v >>= 7;
+        if (v) buf[n] |= 0x80;
+        n++;
+    } while (v);
+    fwrite(buf, 1, (size_t)n, f);
+}
+
+static int get_varint(Replay *r, Uint64 *v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->size) return 0;
+        Uint8 b = r->data[r->pos++];
+        *v |= (Uint64)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return 1;
     }
+    return 0;
 }
-/* ======================================================================== 
-   END: COMPONENT 2 - GRAPHICS & RENDERING
-   ======================================================================== */
 
-/* ========================================================================
-   START: COMPONENT 1 - GAME ENGINE & LOGIC CORE (Member 1 & 2)
-   ======================================================================== */
-void add_score_for_brick(int row, int col) { 
-    (void)row; (void)col; 
-    game_state.score += 10; 
+static inline Uint64 zigzag(Sint64 v) { 
+    return ((Uint64)v << 1) ^ (Uint64)(v >> 63); 
+}
+static inline Sint64 unzigzag(Uint64 v) { 
+    return (Sint64)(v >> 1) ^ -(Sint64)(v & 1); 
 }
 
-void update_engine(float dt) {
-    if (!game_state.is_running || game_state.is_paused || game_state.show_menu) 
-        return;
-    
-    if (!ball.is_held) { 
-        ball.rect.x += ball.vx * ball.speed * dt; 
-        ball.rect.y += ball.vy * ball.speed * dt; 
-    } else { 
-        ball.rect.x = paddle.rect.x + (paddle.rect.w - ball.rect.w)/2.0f; 
-        ball.rect.y = paddle.rect.y - ball.rect.h - 2; 
-    }
-
-    if (!ball.is_held) {
-        if (ball.rect.x <= 0) { 
-            ball.rect.x = 0; 
-            ball.vx = fabsf(ball.vx); 
-            if (sfx_bounce) Mix_PlayChannel(-1, sfx_bounce, 0); 
-        }
-        if (ball.rect.x + ball.rect.w >= WINDOW_WIDTH) { 
-            ball.rect.x = WINDOW_WIDTH - ball.rect.w; 
-            ball.vx = -fabsf(ball.vx); 
-            if (sfx_bounce) Mix_PlayChannel(-1, sfx_bounce, 0); 
-        }
-        if (ball.rect.y <= 0) { 
-            ball.rect.y = 0; 
-            ball.vy = fabsf(ball.vy); 
-            if (sfx_bounce) Mix_PlayChannel(-1, sfx_bounce, 0); 
-        }
-    }
-
-    if (!ball.is_held && ball.vy > 0 && rect_overlap(&ball.rect, &paddle.rect)) {
-        float impact = ((ball.rect.x + ball.rect.w/2.0f) - (paddle.rect.x + paddle.rect.w/2.0f)) / (paddle.rect.w/2.0f);
-        if (impact < -1) impact = -1; 
-        if (impact > 1) impact = 1; 
-        float angle = impact * (75.0f * (M_PI/180.0f));
-        ball.vx = sinf(angle); 
-        ball.vy = -cosf(angle); 
-        ball.speed *= BALL_SPEED_GROWTH; 
-        ball.rect.y = paddle.rect.y - ball.rect.h - 1; 
-        if (sfx_bounce) Mix_PlayChannel(-1, sfx_bounce, 0);
-    }
-
-    if (!ball.is_held) {
-        for (int r=0;r<BRICK_ROWS;r++) {
-            for (int c=0;c<BRICK_COLUMNS;c++) {
-                Brick *b = &bricks[brick_index(r,c)]; 
-                if (!b->is_alive) continue; 
-                RectF br = b->rect;
-                if (rect_overlap(&ball.rect, &br)) {
-                    float ol = (ball.rect.x + ball.rect.w) - br.x; 
-                    float or = (br.x + br.w) - ball.rect.x; 
-                    float ot = (ball.rect.y + ball.rect.h) - br.y; 
-                    float ob = (br.y + br.h) - ball.rect.y; 
-                    float m = ol; 
-                    m = fminf(m, or); 
-                    m = fminf(m, ot); 
-                    m = fminf(m, ob);
-                    
-                    if (m == ol) { 
-                        ball.rect.x -= ol; 
-                        ball.vx = -fabsf(ball.vx); 
-                    }
-                    else if (m == or) { 
-                        ball.rect.x += or; 
-                        ball.vx = fabsf(ball.vx); 
-                    }
-                    else if (m == ot) { 
-                        ball.rect.y -= ot; 
-                        ball.vy = -fabsf(ball.vy); 
-                    }
-                    else { 
-                        ball.rect.y += ob; 
-                        ball.vy = fabsf(ball.vy); 
-                    }
-
-                    b->is_alive = 0; 
-                    game_state.bricks_remaining--;
-                    
-                    if (b->special) {
-                        float cx = b->rect.x + b->rect.w/2.0f; 
-                        float cy = b->rect.y + b->rect.h/2.0f;
-                        for (int ci=0; ci<MAX_COLLECTIBLES; ci++) {
-                            if (!collectibles[ci].alive) {
-                                collectibles[ci].alive = 1; 
-                                collectibles[ci].rect.x = cx - 10; 
-                                collectibles[ci].rect.y = cy - 10; 
-                                collectibles[ci].rect.w = 20; 
-                                collectibles[ci].rect.h = 20; 
-                                collectibles[ci].vx = 0; 
-                                collectibles[ci].vy = 60.0f; 
-                                collectibles[ci].type = 0; 
-                                break;
-                            }
-                        }
-                        b->special = 0;
-                    }
-
-                    add_score_for_brick(r,c);
-                    if (sfx_break) Mix_PlayChannel(-1, sfx_break, 0);
-                    SDL_Color pc = color_palette[b->color_index % 10]; 
-                    spawn_particles(ball.rect.x + ball.rect.w/2, ball.rect.y + ball.rect.h/2, pc, 18);
-                    ball.speed *= 1.015f; 
-                    goto after_brick;
-                }
-            }
-        }
+int replay_record_open(Replay *r, const char *path, Uint32 seed) {
+    r->out = fopen(path, "wb");
+    if (!r->out) { 
+        fprintf(stderr, "replay: cannot write %s\n", path); 
+        return 0; 
+    }
+    setvbuf(r->out, NULL, _IOFBF, 1 << 16);
+    r->mode = REPLAY_RECORD;
+    r->seed = seed;
+    r->tick_hz = sim_tick_hz;
+    r->flags = ball_collisions ? REPLAY_FLAG_BALL_COLLISIONS : 0;
+    Uint8 hdr[12] = { 'A', 'R', 'K', 'R', REPLAY_VERSION, (Uint8)r->flags, 
+                      (Uint8)(r->tick_hz & 0xFF), (Uint8)(r->tick_hz >> 8),
+                      (Uint8)seed, (Uint8)(seed >> 8), (Uint8)(seed >> 16), (Uint8)(seed >> 24) };
+    fwrite(hdr, 1, sizeof(hdr), r->out);
+    return 1;
+}
+
+/* Commands are applied immediately by game_command and logged with the next tick. */
+void replay_note_command(Replay *r, GameCommand cmd) {
+    if (r->mode != REPLAY_RECORD) return;
+    if (r->cmd_count < REPLAY_MAX_CMDS) r->cmds[r->cmd_count++] = (Uint8)cmd;
+    else fprintf(stderr, "replay: too many commands in one tick, dropping one\n");
+}
+
+static void replay_flush_idle(Replay *r) {
+    if (!r->idle_run) return;
+    put_varint(r->out, 0);
+    put_varint(r->out, r->idle_run);
+    r->idle_run = 0;
+}
+
+/* Call once per tick right before update_engine. */
+void replay_record_tick(Replay *r, Game *g) {
+    if (r->mode != REPLAY_RECORD) return;
+    Sint32 q = (Sint32)lroundf(g->paddle.rect.x * REPLAY_SUBPIXEL);
+    g->paddle.rect.x = (float)q / REPLAY_SUBPIXEL;
+    Sint64 dx = (Sint64)q - r->last_x;
+    r->last_x = q;
+    r->ticks++;
+    if (dx == 0 && r->cmd_count == 0) { 
+        r->idle_run++; 
+        return; 
+    }
+    replay_flush_idle(r);
+    put_varint(r->out, (zigzag(dx) << 1) | (r->cmd_count ? 1u : 0u));
+    if (r->cmd_count) {
+        put_varint(r->out, (Uint64)r->cmd_count);
+        fwrite(r->cmds, 1, (size_t)r->cmd_count, r->out);
+        r->cmd_count = 0;
     }
-after_brick: ;
+}
 
-    if (!ball.is_held && ball.rect.y > WINDOW_HEIGHT) {
-        game_state.lives--; 
-        if (sfx_bounce) Mix_PlayChannel(-1, sfx_bounce, 0);
-        if (game_state.lives <= 0) {
-            if (game_state.score > high_score) { 
-                high_score = game_state.score; 
-                save_highscore(); 
-            }
-            add_to_leaderboard(game_state.score);
-            game_state.show_menu = 1; 
-            game_state.is_running = 0;
-        } else {
-            ball.is_held = 1; 
-            ball.speed = BALL_SPEED_INITIAL; 
-            ball.vx = 0; 
-            ball.vy = -1; 
-            paddle.rect.x = (WINDOW_WIDTH - paddle.rect.w)/2.0f;
-        }
+/* Call right after update_engine; the footer holds the state it leaves. */
+void replay_record_result(Replay *r, const Game *g) {
+    if (r->mode != REPLAY_RECORD) return;
+    r->score = g->game_state.score;
+    r->level = g->game_state.level;
+    r->lives = g->game_state.lives;
+}
+
+void replay_record_close(Replay *r) {
+    if (r->mode != REPLAY_RECORD || !r->out) return;
+    replay_flush_idle(r);
+    put_varint(r->out, 0);
+    put_varint(r->out, 0);
+    put_varint(r->out, r->ticks);
+    put_varint(r->out, (Uint64)(r->score > 0 ? r->score : 0));
+    put_varint(r->out, (Uint64)(r->level > 0 ? r->level : 0));
+    put_varint(r->out, (Uint64)(r->lives > 0 ? r->lives : 0));
+    if (fclose(r->out) != 0) fprintf(stderr, "replay: write failed\n");
+    fprintf(stderr, "replay: recorded %llu ticks\n", (unsigned long long)r->ticks);
+    r->out = NULL;
+    r->mode = REPLAY_OFF;
+}
+
+/* The caller keeps ownership of data, which must outlive playback. */
+int replay_play_open(Replay *r, const Uint8 *data, size_t size) {
+    if (size < 12 || memcmp(data, "ARKR", 4) != 0 || data[4] != REPLAY_VERSION) {
+        fprintf(stderr, "replay: not a version %d replay\n", REPLAY_VERSION);
+        return 0;
     }
+    int tick_hz = data[6] | (data[7] << 8);
+    if (tick_hz < SIM_MIN_TICK_HZ || tick_hz > SIM_MAX_TICK_HZ || (data[5] & ~REPLAY_FLAG_BALL_COLLISIONS)) {
+        fprintf(stderr, "replay: not a valid replay\n");
+        return 0;
+    }
+    memset(r, 0, sizeof(*r));
+    r->mode = REPLAY_PLAY;
+    r->data = data;
+    r->size = size;
+    r->flags = data[5];
+    r->tick_hz = tick_hz;
+    r->seed = (Uint32)data[8] | ((Uint32)data[9] << 8) | ((Uint32)data[10] << 16) | ((Uint32)data[11] << 24);
+    r->pos = 12;
+    return 1;
+}
 
-    if (game_state.bricks_remaining <= 0) {
-        game_state.level++;
-        if (game_state.level > MAX_LEVELS) {
-            if (game_state.score > high_score) { 
-                high_score = game_state.score; 
-                save_highscore(); 
+/* Feeds the next logged tick into g. Returns 0 once the stream has ended. */
+int replay_play_tick(Replay *r, Game *g, void (*apply)(Game *, GameCommand)) {
+    if (r->ended) return 0;
+    if (!r->idle_run) {
+        Uint64 tok;
+        if (!get_varint(r, &tok)) { 
+            r->ended = 1; 
+            return 0; 
+        }
+        if (tok == 0) {
+            if (!get_varint(r, &r->idle_run) || r->idle_run == 0) { 
+                r->ended = 1; 
+                return 0; 
             }
-            add_to_leaderboard(game_state.score);
-            game_state.show_menu = 1; 
-            game_state.is_running = 0;
         } else {
-            reset_level(game_state.level);
+            r->last_x += (Sint32)unzigzag(tok >> 1);
+            if (tok & 1) {
+                Uint64 n;
+                if (!get_varint(r, &n) || n > r->size - r->pos) { 
+                    r->ended = 1; 
+                    return 0; 
+                }
+                for (Uint64 i = 0; i < n; i++) apply(g, (GameCommand)r->data[r->pos++]);
+            }
         }
     }
+    if (r->idle_run) r->idle_run--;
+    g->paddle.rect.x = (float)r->last_x / REPLAY_SUBPIXEL;
+    r->ticks++;
+    return 1;
+}
 
-    update_particles(dt); 
-    update_collectibles(dt);
-
-    for (int i=0;i<NUM_STARS;i++) {
-        stars[i].x += stars[i].vx * dt; 
-        stars[i].y += stars[i].vy * dt;
-        if (stars[i].x < -20) stars[i].x = WINDOW_WIDTH + 20; 
-        if (stars[i].x > WINDOW_WIDTH+20) stars[i].x = -20;
-        if (stars[i].y < -20) stars[i].y = WINDOW_HEIGHT + 20; 
-        if (stars[i].y > WINDOW_HEIGHT+20) stars[i].y = -20;
+/* After the stream ends: compares the final state with the logged footer. */
+int replay_play_verify(Replay *r, const Game *g) {
+    Uint64 ticks, score, level, lives;
+    if (!get_varint(r, &ticks) || !get_varint(r, &score) || !get_varint(r, &level) || !get_varint(r, &lives)) {
+        fprintf(stderr, "replay: no footer (recording was cut short), ran %llu ticks\n", 
+                (unsigned long long)r->ticks);
+        return 0;
     }
+    int ok = ticks == r->ticks && (int)score == g->game_state.score && 
+             (int)level == g->game_state.level && (int)lives == g->game_state.lives;
+    fprintf(stderr, "replay: logged %llu ticks score %d level %d lives %d; replayed %llu ticks score %d level %d lives %d: %s\n",
+            (unsigned long long)ticks, (int)score, (int)level, (int)lives, 
+            (unsigned long long)r->ticks, g->game_state.score, g->game_state.level, g->game_state.lives,
+            ok ? "MATCH" : "MISMATCH");
+    return ok;
 }
-/* ======================================================================== 
-   END: COMPONENT 1 - GAME ENGINE & LOGIC CORE
-   ======================================================================== */
 
 /* ========================================================================
-   START: COMPONENT 2 - GRAPHICS & RENDERING (Member 3 & 4)
+   SIM THREAD LINK
+   - With --threaded the simulation runs on its own thread at the fixed
+     tick rate; the main thread handles events and renders (see THREADED
+     MODE for the thread itself and the snapshots it publishes)
+   - Main -> sim: game commands through a single-producer ring, paddle
+     input through atomics: keyboard direction and the newest mouse x
+   - Nothing here blocks: a full command ring drops the command
    ======================================================================== */
-void draw_rectf(SDL_Renderer *ren, RectF *f) { 
-    SDL_Rect rr = { (int)f->x, (int)f->y, (int)f->w, (int)f->h }; 
-    SDL_RenderFillRect(ren, &rr); 
-}
+#define SIM_CMD_QUEUE 32
 
-void draw_ball_with_glow(Ball *b) {
-    int rings = 6;
-    for (int i = rings; i >= 1; i--) {
-        float t = (float)i / (float)rings;
-        Uint8 a = (Uint8)(40 * t);
-        SDL_SetRenderDrawColor(renderer, 255, 240, 180, a);
-        RectF gr = { b->rect.x - (rings-i)*2.0f, b->rect.y - (rings-i)*2.0f, 
-                     b->rect.w + (rings-i)*4.0f, b->rect.h + (rings-i)*4.0f };
-        draw_rectf(renderer, &gr);
-    }
-    SDL_SetRenderDrawColor(renderer, 255, 240, 180, 255); 
-    draw_rectf(renderer, &b->rect);
-}
+typedef struct {
+    int active;                 /* set while the sim thread owns the game */
+    Uint8 cmds[SIM_CMD_QUEUE];
+    SDL_atomic_t cmd_head;      /* next write, main thread */
+    SDL_atomic_t cmd_tail;      /* next read, sim thread */
+    SDL_atomic_t paddle_dir;    /* -1, 0 or +1 from the keyboard */
+    SDL_atomic_t mouse_x;       /* newest mouse x + 1, 0 once taken */
+    SDL_atomic_t quit;
+} SimLink;
 
-void draw_paddle(Paddle *p) {
-    SDL_SetRenderDrawColor(renderer, 30, 90, 140, 255); 
-    draw_rectf(renderer, &p->rect);
-    SDL_SetRenderDrawColor(renderer, 220, 240, 255, 255);
-    RectF top = { p->rect.x + 4, p->rect.y + 2, p->rect.w - 8, p->rect.h/2 - 2 }; 
-    draw_rectf(renderer, &top);
+SimLink sim_link;
+
+int sim_post_command(SimLink *l, GameCommand cmd) {
+    int head = SDL_AtomicGet(&l->cmd_head);
+    if (head - SDL_AtomicGet(&l->cmd_tail) >= SIM_CMD_QUEUE) return 0;
+    l->cmds[head % SIM_CMD_QUEUE] = (Uint8)cmd;
+    SDL_AtomicSet(&l->cmd_head, head + 1);
+    return 1;
 }
 
-void draw_textured_brick(Brick *b) {
-    SDL_Color base = color_palette[b->color_index % 10]; 
-    SDL_SetRenderDrawColor(renderer, base.r, base.g, base.b, 255); 
-    draw_rectf(renderer, &b->rect);
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 110); 
-    RectF shine = { b->rect.x + 6, b->rect.y + 4, b->rect.w * 0.5f, b->rect.h * 0.35f }; 
-    draw_rectf(renderer, &shine);
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 40); 
-    RectF shadow = { b->rect.x + 4, b->rect.y + b->rect.h - 6, b->rect.w - 6, 6 }; 
-    draw_rectf(renderer, &shadow);
+int sim_next_command(SimLink *l, GameCommand *cmd) {
+    int tail = SDL_AtomicGet(&l->cmd_tail);
+    if (tail == SDL_AtomicGet(&l->cmd_head)) return 0;
+    *cmd = (GameCommand)l->cmds[tail % SIM_CMD_QUEUE];
+    SDL_AtomicSet(&l->cmd_tail, tail + 1);
+    return 1;
 }
-/* ======================================================================== 
-   END: COMPONENT 2 - GRAPHICS & RENDERING
-   ======================================================================== */
 
 /* ========================================================================
-   START: COMPONENT 5 - SOUND, UI & MENU SYSTEM (Member 9 & 10)
+   SPECTATOR STREAM
+   - --spectate TARGET sends the game's state once per sim tick, so lobby
+     screens can mirror a cabinet without capturing video. TARGET is
+     udp:HOST:PORT, or a path ("-" for stdout, or a named pipe)
+   - Each packet is bit-packed and encodes the state as a delta from the
+     previous packet. Only changed fields are sent: paddle, balls,
+     pickups and game state, plus the indices of bricks that died. Every
+     SPEC_KEY_SECONDS a key packet restates everything against a zero
+     state and the board is resent, so a late or lossy viewer resyncs
+   - Board packets carry a level's layout in chunks of SPEC_BOARD_CHUNK
+     cells. They are sent whenever the board changes and with every key
+   - Packets are encoded on the sim thread and written by their own
+     thread. A full queue drops the packet and forces a key, so a stalled
+     reader never stalls the game
+   - On a pipe every packet is prefixed with a 16-bit little-endian
+     length; a UDP datagram is one packet
+   - Positions are 1/8 px fixed point from -SPEC_POS_BIAS. Deltas take a
+     2-bit prefix: 00 unchanged, 01 6-bit step, 10 10-bit step, 11 the
+     absolute value
    ======================================================================== */
-static const unsigned char FONT_5x7[][5] = {
-    {0x3E,0x51,0x49,0x45,0x3E},{0x00,0x42,0x7F,0x40,0x00},{0x42,0x61,0x51,0x49,0x46},{0x21,0x41,0x45,0x4B,0x31},
-    {0x18,0x14,0x12,0x7F,0x10},{0x27,0x45,0x45,0x45,0x39},{0x3C,0x4A,0x49,0x49,0x30},{0x01,0x71,0x09,0x05,0x03},
-    {0x36,0x49,0x49,0x49,0x36},{0x06,0x49,0x49,0x29,0x1E},
-    {0x7C,0x12,0x11,0x12,0x7C},{0x7F,0x49,0x49,0x49,0x36},{0x3E,0x41,0x41,0x41,0x22},{0x7F,0x41,0x41,0x22,0x1C},
-    {0x7F,0x49,0x49,0x49,0x41},{0x7F,0x09,0x09,0x09,0x01},{0x3E,0x41,0x49,0x49,0x7A},{0x7F,0x08,0x08,0x08,0x7F},
-    {0x00,0x41,0x7F,0x41,0x00},{0x20,0x40,0x41,0x3F,0x01},{0x7F,0x08,0x14,0x22,0x41},{0x7F,0x40,0x40,0x40,0x40},
-    {0x7F,0x02,0x04,0x02,0x7F},{0x7F,0x04,0x08,0x10,0x7F},{0x3E,0x41,0x41,0x41,0x3E},{0x7F,0x09,0x09,0x09,0x06},
-    {0x3E,0x41,0x51,0x21,0x5E},{0x7F,0x09,0x19,0x29,0x46},{0x46,0x49,0x49,0x49,0x31},{0x01,0x01,0x7F,0x01,0x01},
-    {0x3F,0x40,0x40,0x40,0x3F},{0x1F,0x20,0x40,0x20,0x1F},{0x3F,0x40,0x38,0x40,0x3F},{0x63,0x14,0x08,0x14,0x63},
-    {0x07,0x08,0x70,0x08,0x07},{0x61,0x51,0x49,0x45,0x43}
+#define SPEC_PACKET_MAX 4096
+#define SPEC_QUEUE 64
+#define SPEC_KEY_SECONDS 2
+#define SPEC_BOARD_CHUNK 1024
+#define SPEC_DEATHS_MAX 512         /* more wait for the next packet */
+#define SPEC_POS_BIAS 256
+#define SPEC_POS_BITS 14
+#define SPEC_CELL_BITS 17
+#define SPEC_MAGIC 0xA0
+
+enum { SPEC_KEY, SPEC_DELTA, SPEC_BOARD };
+enum { 
+    SPEC_F_PADDLE = 1, SPEC_F_BALLS = 2, SPEC_F_COLLECT = 4, SPEC_F_STATE = 8, SPEC_F_DEATHS = 16,
+    SPEC_F_ALL = 31
 };
 
-static int char_index_for_hud(char ch) {
-    if (ch >= '0' && ch <= '9') return ch - '0';
-    if (ch >= 'A' && ch <= 'Z') return 10 + (ch - 'A');
-    return -1;
+typedef struct { Uint16 x, y; Uint8 held; } SpecBall;
+
+/* What a spectator sees of one tick, quantized as sent. */
+typedef struct {
+    Uint32 tick;
+    Uint16 paddle_x, paddle_w;
+    int ball_count;
+    SpecBall balls[MAX_BALLS];
+    Uint8 collect_alive;        /* bit per Game.collectibles slot */
+    Uint16 collect_x[MAX_COLLECTIBLES], collect_y[MAX_COLLECTIBLES];
+    Uint8 collect_type[MAX_COLLECTIBLES];
+    Sint32 score, lives, level, bricks_remaining, high_score;
+    Uint8 flags;                /* paused, running, menu */
+} SpecState;
+
+typedef char spec_collectibles_fit_mask[MAX_COLLECTIBLES <= 8 ? 1 : -1];
+
+static Uint16 spec_pos(float v) {
+    int q = (int)lroundf((v + SPEC_POS_BIAS) * 8.0f);
+    if (q < 0) q = 0;
+    if (q >= 1 << SPEC_POS_BITS) q = (1 << SPEC_POS_BITS) - 1;
+    return (Uint16)q;
 }
 
-void draw_glyph(char ch, int x, int y, int scale, SDL_Color color) {
-    int idx = char_index_for_hud(ch);
-    if (idx < 0) return;
-    const unsigned char *cols = FONT_5x7[idx];
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    for (int col = 0; col < 5; col++) {
-        unsigned char colbits = cols[col];
-        for (int row = 0; row < 7; row++) {
-            int bit = (colbits >> row) & 1;
-            if (bit) {
-                SDL_Rect r = { x + col * scale, y + row * scale, scale, scale };
-                SDL_RenderFillRect(renderer, &r);
-            }
-        }
+static float spec_unpos(Uint16 q) { return q / 8.0f - SPEC_POS_BIAS; }
+
+static void spec_capture(SpecState *s, const Game *g, Uint32 tick) {
+    s->tick = tick;
+    s->paddle_x = spec_pos(g->paddle.rect.x);
+    s->paddle_w = spec_pos(g->paddle.rect.w);
+    s->ball_count = g->ball_count;
+    for (int i = 0; i < g->ball_count; i++) {
+        s->balls[i].x = spec_pos(g->balls[i].rect.x);
+        s->balls[i].y = spec_pos(g->balls[i].rect.y);
+        s->balls[i].held = (Uint8)(g->balls[i].is_held != 0);
     }
+    s->collect_alive = 0;
+    for (int i = 0; i < MAX_COLLECTIBLES; i++) {
+        const Collectible *c = &g->collectibles[i];
+        s->collect_x[i] = s->collect_y[i] = 0;
+        s->collect_type[i] = 0;
+        if (!c->alive) continue;
+        s->collect_alive |= (Uint8)(1u << i);
+        s->collect_x[i] = spec_pos(c->rect.x);
+        s->collect_y[i] = spec_pos(c->rect.y);
+        s->collect_type[i] = (Uint8)c->type;
+    }
+    const GameState *gs = &g->game_state;
+    s->score = gs->score; 
+    s->lives = gs->lives; 
+    s->level = gs->level;
+    s->bricks_remaining = gs->bricks_remaining; 
+    s->high_score = g->high_score;
+    s->flags = (Uint8)((gs->is_paused != 0) | (gs->is_running != 0) << 1 | (gs->show_menu != 0) << 2);
 }
 
-void draw_text_pixel(const char *s, int x, int y, int scale, SDL_Color col) {
-    int cx = x;
-    for (size_t i = 0; i < strlen(s); ++i) {
-        char c = s[i];
-        if (c == ' ') { cx += (6 * scale); continue; }
-        draw_glyph(c, cx, y, scale, col);
-        cx += (6 * scale);
+/* LSB-first bit buffer over zeroed memory; running past the end sets
+   overflow and stops writing (or reads zeros). */
+typedef struct { Uint8 *buf; int cap_bits, pos, overflow; } BitBuf;
+
+static void bits_put(BitBuf *b, Uint32 v, int n) {
+    if (b->pos + n > b->cap_bits) { 
+        b->overflow = 1; 
+        return; 
     }
+    for (int i = 0; i < n; i++, b->pos++) 
+        if (v >> i & 1) b->buf[b->pos >> 3] |= (Uint8)(1u << (b->pos & 7));
 }
 
-void draw_number_left(int x, int y, int scale, int value, SDL_Color col) {
-    char buf[32];
-    if (value < 0) value = 0;
-    snprintf(buf, sizeof(buf), "%d", value);
-    int len = (int)strlen(buf);
-    for (int i = 0; i < len; ++i) 
-        draw_glyph(buf[i], x + i * (6 * scale), y, scale, col);
+static Uint32 bits_get(BitBuf *b, int n) {
+    if (b->pos + n > b->cap_bits) { 
+        b->overflow = 1; 
+        return 0; 
+    }
+    Uint32 v = 0;
+    for (int i = 0; i < n; i++, b->pos++) 
+        v |= (Uint32)(b->buf[b->pos >> 3] >> (b->pos & 7) & 1) << i;
+    return v;
 }
 
-void draw_number_right(int rx, int y, int scale, int value, SDL_Color col) {
-    char buf[32];
-    if (value < 0) value = 0;
-    snprintf(buf, sizeof(buf), "%d", value);
-    int len = (int)strlen(buf);
-    int total_w = len * (6 * scale);
-    int start = rx - total_w + 1;
-    for (int i = 0; i < len; ++i) 
-        draw_glyph(buf[i], start + i * (6 * scale), y, scale, col);
+static void bits_put_delta(BitBuf *b, Sint32 cur, Sint32 prev, int full_bits) {
+    Sint32 d = cur - prev;
+    if (d == 0) {
+        bits_put(b, 0, 2);
+    } else if (d >= -32 && d < 32) { 
+        bits_put(b, 1, 2); 
+        bits_put(b, (Uint32)d & 63, 6); 
+    } else if (d >= -512 && d < 512) { 
+        bits_put(b, 2, 2); 
+        bits_put(b, (Uint32)d & 1023, 10); 
+    } else { 
+        bits_put(b, 3, 2); 
+        bits_put(b, (Uint32)cur, full_bits); 
+    }
 }
-/* ======================================================================== 
-   END: COMPONENT 5 - SOUND, UI & MENU SYSTEM
-   ======================================================================== */
 
-/* ========================================================================
-   START: COMPONENT 2 - GRAPHICS & RENDERING (Member 3 & 4)
-   ======================================================================== */
-void spawn_stars() { 
-    for (int i=0;i<NUM_STARS;i++) { 
-        stars[i].x = (float)(rand()% (WINDOW_WIDTH+200) - 100); 
-        stars[i].y = (float)(rand()% (WINDOW_HEIGHT+200) - 100); 
-        stars[i].layer = rand()%STAR_LAYERS; 
-        stars[i].size = 1.0f + (float)(rand()%3) + (STAR_LAYERS - stars[i].layer); 
-        stars[i].vx = (stars[i].layer+1) * ( (rand()%20 - 10) / 100.0f ); 
-        stars[i].vy = (stars[i].layer+1) * ( (rand()%20 - 10) / 100.0f ); 
-    } 
+static Sint32 bits_get_delta(BitBuf *b, Sint32 prev, int full_bits) {
+    switch (bits_get(b, 2)) {
+    case 0: return prev;
+    case 1: { Sint32 d = (Sint32)bits_get(b, 6); return prev + (d >= 32 ? d - 64 : d); }
+    case 2: { Sint32 d = (Sint32)bits_get(b, 10); return prev + (d >= 512 ? d - 1024 : d); }
+    default: return (Sint32)bits_get(b, full_bits);
+    }
 }
 
-void draw_space_background(SDL_Renderer *ren, float tsec) {
-    for (int y = 0; y < WINDOW_HEIGHT; y += 2) {
-        float ty = (float)y / (float)WINDOW_HEIGHT;
-        Uint8 r = (Uint8)(8 + ty * 10);
-        Uint8 g = (Uint8)(10 + ty * 20);
-        Uint8 b = (Uint8)(28 + ty * 50);
-        SDL_SetRenderDrawColor(ren, r, g, b, 255);
-        SDL_Rect line = {0, y, WINDOW_WIDTH, 2};
-        SDL_RenderFillRect(ren, &line);
+/* Encodes s against ref (a zeroed state for keys) into b. deaths lists
+   the brick indices gone since the previous packet, ascending. */
+static void spec_encode(BitBuf *b, int type, Uint16 seq, const SpecState *s, const SpecState *ref, 
+                        Uint32 board_serial, const Uint32 *deaths, int death_count) {
+    bits_put(b, SPEC_MAGIC | type, 8);
+    bits_put(b, seq, 16);
+    if (type == SPEC_KEY) {
+        bits_put(b, s->tick, 32);
+        bits_put(b, (Uint32)sim_tick_hz, 11);
+    } else {
+        bits_put_delta(b, (Sint32)s->tick, (Sint32)ref->tick, 32);
+    }
+    int fields = 0;
+    if (type == SPEC_KEY) {
+        fields = SPEC_F_ALL & ~SPEC_F_DEATHS;
+    } else {
+        if (s->paddle_x != ref->paddle_x || s->paddle_w != ref->paddle_w) fields |= SPEC_F_PADDLE;
+        if (s->ball_count != ref->ball_count || 
+            memcmp(s->balls, ref->balls, (size_t)s->ball_count * sizeof(SpecBall)) != 0) fields |= SPEC_F_BALLS;
+        if (s->collect_alive != ref->collect_alive || 
+            memcmp(s->collect_x, ref->collect_x, sizeof(s->collect_x)) != 0 || 
+            memcmp(s->collect_y, ref->collect_y, sizeof(s->collect_y)) != 0 || 
+            memcmp(s->collect_type, ref->collect_type, sizeof(s->collect_type)) != 0) fields |= SPEC_F_COLLECT;
+        if (s->score != ref->score || s->lives != ref->lives || s->level != ref->level || 
+            s->bricks_remaining != ref->bricks_remaining || s->high_score != ref->high_score || 
+            s->flags != ref->flags) fields |= SPEC_F_STATE;
+        if (death_count) fields |= SPEC_F_DEATHS;
     }
+    bits_put(b, (Uint32)fields, 5);
 
-    float offset = sinf(tsec * 0.12f) * 60.0f;
-    for (int i = 0; i < 80; i++) {
-        float py = WINDOW_HEIGHT * 0.25f + sinf(i * 0.12f + offset * 0.01f) * 16.0f + offset * 0.05f;
-        float width = WINDOW_WIDTH * (0.5f + 0.12f * sinf(i * 0.3f + offset * 0.02f));
-        Uint8 alpha = (Uint8)(20 + (i % 4) * 6);
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderDrawColor(ren, 120, 40, 200, alpha);
-        SDL_Rect band = { (int)(WINDOW_WIDTH / 2 - width / 2), (int)(py + i * 1.0f), (int)width, 6 };
-        SDL_RenderFillRect(ren, &band);
+    if (fields & SPEC_F_PADDLE) {
+        bits_put_delta(b, s->paddle_x, ref->paddle_x, SPEC_POS_BITS);
+        bits_put_delta(b, s->paddle_w, ref->paddle_w, SPEC_POS_BITS);
+    }
+    if (fields & SPEC_F_BALLS) {
+        static const SpecBall none;
+        bits_put_delta(b, s->ball_count, ref->ball_count, 10);
+        for (int i = 0; i < s->ball_count; i++) {
+            const SpecBall *p = i < ref->ball_count ? &ref->balls[i] : &none;
+            bits_put_delta(b, s->balls[i].x, p->x, SPEC_POS_BITS);
+            bits_put_delta(b, s->balls[i].y, p->y, SPEC_POS_BITS);
+            bits_put(b, s->balls[i].held, 1);
+        }
+    }
+    if (fields & SPEC_F_COLLECT) {
+        bits_put(b, s->collect_alive, MAX_COLLECTIBLES);
+        for (int i = 0; i < MAX_COLLECTIBLES; i++) {
+            if (!(s->collect_alive >> i & 1)) continue;
+            bits_put_delta(b, s->collect_x[i], ref->collect_x[i], SPEC_POS_BITS);
+            bits_put_delta(b, s->collect_y[i], ref->collect_y[i], SPEC_POS_BITS);
+            bits_put(b, s->collect_type[i], 2);
+        }
+    }
+    if (fields & SPEC_F_STATE) {
+        bits_put_delta(b, s->score, ref->score, 32);
+        bits_put_delta(b, s->lives, ref->lives, 8);
+        bits_put_delta(b, s->level, ref->level, 8);
+        bits_put_delta(b, s->bricks_remaining, ref->bricks_remaining, SPEC_CELL_BITS);
+        bits_put_delta(b, s->high_score, ref->high_score, 32);
+        bits_put(b, s->flags, 3);
     }
+    if (fields & SPEC_F_DEATHS) {
+        bits_put(b, board_serial & 0xFFFF, 16);
+        bits_put(b, (Uint32)death_count, 10);
+        Sint32 prev = 0;
+        for (int i = 0; i < death_count; i++) {
+            bits_put_delta(b, (Sint32)deaths[i], prev, SPEC_CELL_BITS);
+            prev = (Sint32)deaths[i];
+        }
+    }
+}
+
+/* Decodes a key or delta against ref into s; deaths go to deaths[] with
+   their board serial. Returns 0 for a malformed packet. */
+static int spec_decode(BitBuf *b, SpecState *s, const SpecState *ref, int *tick_hz, 
+                       Uint32 *board_serial, Uint32 *deaths, int *death_count) {
+    static const SpecState zero;
+    int type = (int)bits_get(b, 8) & 0xF;
+    bits_get(b, 16);
+    if (type == SPEC_KEY) ref = &zero;
+    *s = *ref;
+    *death_count = 0;
+    if (type == SPEC_KEY) {
+        s->tick = bits_get(b, 32);
+        *tick_hz = (int)bits_get(b, 11);
+    } else {
+        s->tick = (Uint32)bits_get_delta(b, (Sint32)ref->tick, 32);
+    }
+    int fields = (int)bits_get(b, 5);
+    if (fields & SPEC_F_PADDLE) {
+        s->paddle_x = (Uint16)bits_get_delta(b, ref->paddle_x, SPEC_POS_BITS);
+        s->paddle_w = (Uint16)bits_get_delta(b, ref->paddle_w, SPEC_POS_BITS);
+    }
+    if (fields & SPEC_F_BALLS) {
+        static const SpecBall none;
+        s->ball_count = bits_get_delta(b, ref->ball_count, 10);
+        if (s->ball_count < 0 || s->ball_count > MAX_BALLS) return 0;
+        for (int i = 0; i < s->ball_count; i++) {
+            const SpecBall *p = i < ref->ball_count ? &ref->balls[i] : &none;
+            s->balls[i].x = (Uint16)bits_get_delta(b, p->x, SPEC_POS_BITS);
+            s->balls[i].y = (Uint16)bits_get_delta(b, p->y, SPEC_POS_BITS);
+            s->balls[i].held = (Uint8)bits_get(b, 1);
+        }
+    }
+    if (fields & SPEC_F_COLLECT) {
+        s->collect_alive = (Uint8)bits_get(b, MAX_COLLECTIBLES);
+        for (int i = 0; i < MAX_COLLECTIBLES; i++) {
+            if (!(s->collect_alive >> i & 1)) continue;
+            s->collect_x[i] = (Uint16)bits_get_delta(b, ref->collect_x[i], SPEC_POS_BITS);
+            s->collect_y[i] = (Uint16)bits_get_delta(b, ref->collect_y[i], SPEC_POS_BITS);
+            s->collect_type[i] = (Uint8)bits_get(b, 2);
+        }
+    }
+    if (fields & SPEC_F_STATE) {
+        s->score = bits_get_delta(b, ref->score, 32);
+        s->lives = bits_get_delta(b, ref->lives, 8);
+        s->level = bits_get_delta(b, ref->level, 8);
+        s->bricks_remaining = bits_get_delta(b, ref->bricks_remaining, SPEC_CELL_BITS);
+        s->high_score = bits_get_delta(b, ref->high_score, 32);
+        s->flags = (Uint8)bits_get(b, 3);
+    }
+    if (fields & SPEC_F_DEATHS) {
+        *board_serial = bits_get(b, 16);
+        int n = (int)bits_get(b, 10);
+        Sint32 prev = 0;
+        /* the writer never sends more; anything larger is not ours */
+        if (n > SPEC_DEATHS_MAX) return 0;
+        for (int i = 0; i < n; i++) {
+            prev = bits_get_delta(b, prev, SPEC_CELL_BITS);
+            if (prev < 0 || prev >= BOARD_MAX_CELLS) return 0;
+            deaths[i] = (Uint32)prev;
+        }
+        *death_count = n;
+    }
+    return !b->overflow;
+}
 
-    for (int i = 0; i < NUM_STARS; i++) {
-        Star *s = &stars[i];
-        int br = (int)fminf(255.0f, 180.0f + 40.0f * (1.0f / (s->layer + 1)));
-        if (br < 0) br = 0;
-        if (br > 255) br = 255;
-        SDL_SetRenderDrawColor(ren, (Uint8)br, (Uint8)br, (Uint8)br, 255);
-        SDL_Rect sr = { (int)s->x, (int)s->y, (int)fmaxf(1.0f, s->size), (int)fmaxf(1.0f, s->size) };
-        SDL_RenderFillRect(ren, &sr);
+/* One chunk of the board: cells [first, first + count) as an alive bit
+   and, for a live brick, its 4-bit palette index. */
+static void spec_encode_board(BitBuf *b, Uint16 seq, const Board *bd, int first, int count) {
+    bits_put(b, SPEC_MAGIC | SPEC_BOARD, 8);
+    bits_put(b, seq, 16);
+    bits_put(b, bd->serial & 0xFFFF, 16);
+    bits_put(b, (Uint32)bd->rows, 9);
+    bits_put(b, (Uint32)bd->cols, 9);
+    bits_put(b, (Uint32)first, SPEC_CELL_BITS);
+    bits_put(b, (Uint32)count, 11);
+    for (int i = first; i < first + count; i++) {
+        int alive = brick_alive(bd, i);
+        bits_put(b, (Uint32)alive, 1);
+        if (alive) bits_put(b, (Uint32)brick_color(bd, i), 4);
     }
 }
 
-void render_scene() {
-    float tsec = (float)(SDL_GetTicks() / 1000.0f);
-    draw_space_background(renderer, tsec);
+/* --- transport: udp:HOST:PORT or a path, one per stream --- */
+typedef struct {
+    FILE *f;
+    SpecSocket sock;
+    struct sockaddr_storage peer;
+    socklen_t peer_len;
+    int own_file;
+} SpecLink;
 
-    for (int r = 0; r < BRICK_ROWS; r++) {
-        for (int c = 0; c < BRICK_COLUMNS; c++) { 
-            Brick *b = &bricks[brick_index(r,c)]; 
-            if (b->is_alive) draw_textured_brick(b); 
+static int spec_link_open(SpecLink *l, const char *target, int sending) {
+    memset(l, 0, sizeof(*l));
+    l->sock = SPEC_NO_SOCKET;
+    if (strncmp(target, "udp:", 4) != 0) {
+        if (strcmp(target, "-") == 0) {
+            l->f = sending ? stdout : stdin;
+#ifdef _WIN32
+            _setmode(_fileno(l->f), _O_BINARY);
+#endif
+        } else {
+            l->f = fopen(target, sending ? "wb" : "rb");
+            l->own_file = 1;
         }
+        if (!l->f) fprintf(stderr, "spectate: cannot open %s\n", target);
+#ifndef _WIN32
+        if (sending) signal(SIGPIPE, SIG_IGN);   /* a closed viewer is a write error, not a kill */
+#endif
+        return l->f != NULL;
+    }
+    char host[256];
+    snprintf(host, sizeof(host), "%s", target + 4);
+    char *port = strrchr(host, ':');
+    if (!port) { 
+        fprintf(stderr, "spectate: %s: expected udp:HOST:PORT\n", target); 
+        return 0; 
+    }
+    *port++ = '\0';
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return 0;
+#endif
+    struct addrinfo hints, *ai = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = sending ? 0 : AI_PASSIVE;
+    if (getaddrinfo(host[0] ? host : NULL, port, &hints, &ai) != 0 || !ai) {
+        fprintf(stderr, "spectate: cannot resolve %s\n", target);
+        return 0;
     }
+    l->sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    int ok = l->sock != SPEC_NO_SOCKET;
+    if (ok && sending) {
+        memcpy(&l->peer, ai->ai_addr, ai->ai_addrlen);
+        l->peer_len = (socklen_t)ai->ai_addrlen;
+    } else if (ok) {
+        /* receive timeout, so the reader thread notices quit */
+#ifdef _WIN32
+        DWORD ms = 100;
+        setsockopt(l->sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&ms, sizeof(ms));
+#else
+        struct timeval tv = { 0, 100000 };
+        setsockopt(l->sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#endif
+        ok = bind(l->sock, ai->ai_addr, (socklen_t)ai->ai_addrlen) == 0;
+    }
+    freeaddrinfo(ai);
+    if (!ok) fprintf(stderr, "spectate: cannot %s %s\n", sending ? "open" : "bind", target);
+    return ok;
+}
 
-    for (int i = 0; i < MAX_PARTICLES; i++) { 
-        if (!particles[i].alive) continue; 
-        float life_t = particles[i].life / particles[i].max_life; 
-        Uint8 a = (Uint8)(255 * (1.0f - life_t)); 
-        SDL_SetRenderDrawColor(renderer, particles[i].col.r, particles[i].col.g, particles[i].col.b, a); 
-        SDL_Rect pr = { (int)particles[i].x, (int)particles[i].y, 3, 3 }; 
-        SDL_RenderFillRect(renderer, &pr); 
+static void spec_link_close(SpecLink *l) {
+    if (l->f && l->own_file) fclose(l->f);
+    else if (l->f) fflush(l->f);
+    if (l->sock != SPEC_NO_SOCKET) spec_closesocket(l->sock);
+    memset(l, 0, sizeof(*l));
+    l->sock = SPEC_NO_SOCKET;
+}
+
+static int spec_link_send(SpecLink *l, const Uint8 *data, int len) {
+    if (l->f) {
+        Uint8 hdr[2] = { (Uint8)len, (Uint8)(len >> 8) };
+        return fwrite(hdr, 1, 2, l->f) == 2 && fwrite(data, 1, (size_t)len, l->f) == (size_t)len;
     }
+    return sendto(l->sock, (const char *)data, len, 0, (const struct sockaddr *)&l->peer, l->peer_len) == len;
+}
 
-    for (int ci = 0; ci < MAX_COLLECTIBLES; ci++) { 
-        if (!collectibles[ci].alive) continue; 
-        SDL_SetRenderDrawColor(renderer, 255, 200, 80, 255); 
-        SDL_Rect cr = { (int)collectibles[ci].rect.x, (int)collectibles[ci].rect.y, 
-                        (int)collectibles[ci].rect.w, (int)collectibles[ci].rect.h }; 
-        SDL_RenderFillRect(renderer, &cr); 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 100); 
-        SDL_RenderDrawRect(renderer, &cr); 
+/* Length of the packet read into data, 0 for nothing yet (UDP timeout),
+   -1 at end of stream. */
+static int spec_link_recv(SpecLink *l, Uint8 *data) {
+    if (l->f) {
+        Uint8 hdr[2];
+        if (fread(hdr, 1, 2, l->f) != 2) return -1;
+        int len = hdr[0] | hdr[1] << 8;
+        if (len > SPEC_PACKET_MAX || fread(data, 1, (size_t)len, l->f) != (size_t)len) return -1;
+        return len;
     }
+    int n = (int)recvfrom(l->sock, (char *)data, SPEC_PACKET_MAX, 0, NULL, NULL);
+    return n > 0 ? n : 0;
+}
 
-    draw_paddle(&paddle);
-    draw_ball_with_glow(&ball);
+/* --- packet queue between the sim (or reader) thread and the other end --- */
+typedef struct { Uint16 len; Uint8 data[SPEC_PACKET_MAX]; } SpecPacket;
 
-    SDL_Rect hudStrip = { 0, 0, WINDOW_WIDTH, 44 };
-    SDL_SetRenderDrawColor(renderer, 6, 8, 20, 220);
-    SDL_RenderFillRect(renderer, &hudStrip);
+typedef struct {
+    SpecPacket slot[SPEC_QUEUE];
+    SDL_atomic_t head, tail;    /* head: next write; tail: next read */
+} SpecQueue;
 
-    SDL_Color fg = { 235, 235, 255, 255 };
-    int labelScale = 2;
-    int digitScale = 4;
+static SpecPacket *spec_queue_back(SpecQueue *q) {
+    int head = SDL_AtomicGet(&q->head);
+    if (head - SDL_AtomicGet(&q->tail) >= SPEC_QUEUE) return NULL;
+    return &q->slot[head % SPEC_QUEUE];
+}
+
+static void spec_queue_push(SpecQueue *q) { SDL_AtomicAdd(&q->head, 1); }
+
+static SpecPacket *spec_queue_front(SpecQueue *q) {
+    int tail = SDL_AtomicGet(&q->tail);
+    return tail == SDL_AtomicGet(&q->head) ? NULL : &q->slot[tail % SPEC_QUEUE];
+}
+
+static void spec_queue_pop(SpecQueue *q) { SDL_AtomicAdd(&q->tail, 1); }
+
+/* --- sender --- */
+typedef struct {
+    int active;
+    SpecLink link;
+    SpecQueue queue;
+    SDL_sem *wake;
+    SDL_Thread *thread;
+    SDL_atomic_t quit;
+    Uint16 seq;
+    Uint32 tick;
+    int force_key;
+    Uint32 last_key;
+    SpecState sent;
+    Uint32 sent_serial;
+    Uint64 sent_alive[BOARD_WORDS];
+    Uint32 deaths[SPEC_DEATHS_MAX];
+    SpecState scratch;
+    Uint64 packets, bytes, dropped;     /* packets and bytes: writer thread */
+} SpecStream;
+
+SpecStream spec_out;
+
+static int spec_writer_main(void *arg) {
+    SpecStream *st = (SpecStream *)arg;
+    for (;;) {
+        SDL_SemWait(st->wake);
+        SpecPacket *p;
+        while ((p = spec_queue_front(&st->queue)) != NULL) {
+            if (spec_link_send(&st->link, p->data, p->len)) {
+                st->packets++;
+                st->bytes += p->len;
+            }
+            spec_queue_pop(&st->queue);
+        }
+        if (st->link.f) fflush(st->link.f);
+        if (SDL_AtomicGet(&st->quit)) break;
+    }
+    return 0;
+}
+
+int spectate_open(SpecStream *st, const char *target) {
+    memset(st, 0, sizeof(*st));
+    if (!spec_link_open(&st->link, target, 1)) return 0;
+    st->wake = SDL_CreateSemaphore(0);
+    if (st->wake) st->thread = SDL_CreateThread(spec_writer_main, "spectate", st);
+    if (!st->thread) {
+        fprintf(stderr, "spectate: writer thread failed: %s\n", SDL_GetError());
+        if (st->wake) SDL_DestroySemaphore(st->wake);
+        spec_link_close(&st->link);
+        return 0;
+    }
+    st->force_key = 1;
+    st->active = 1;
+    return 1;
+}
+
+/* Claims a queue slot and starts a packet in it; NULL if the queue is full. */
+static SpecPacket *spec_begin(SpecStream *st, BitBuf *b) {
+    SpecPacket *p = spec_queue_back(&st->queue);
+    if (!p) return NULL;
+    memset(p->data, 0, sizeof(p->data));
+    b->buf = p->data;
+    b->cap_bits = SPEC_PACKET_MAX * 8;
+    b->pos = b->overflow = 0;
+    return p;
+}
+
+static int spec_commit(SpecStream *st, SpecPacket *p, const BitBuf *b) {
+    if (b->overflow) return 0;
+    p->len = (Uint16)((b->pos + 7) / 8);
+    spec_queue_push(&st->queue);
+    SDL_SemPost(st->wake);
+    st->seq++;
+    return 1;
+}
+
+static int spec_send_board(SpecStream *st, const Board *bd) {
+    int cells = bd->rows * bd->cols;
+    for (int first = 0; first < cells; first += SPEC_BOARD_CHUNK) {
+        BitBuf b;
+        SpecPacket *p = spec_begin(st, &b);
+        if (!p) return 0;
+        spec_encode_board(&b, st->seq, bd, first, cells - first < SPEC_BOARD_CHUNK ? cells - first : SPEC_BOARD_CHUNK);
+        if (!spec_commit(st, p, &b)) return 0;
+    }
+    memcpy(st->sent_alive, bd->alive, sizeof(st->sent_alive));
+    st->sent_serial = bd->serial;
+    return 1;
+}
+
+/* Called after every sim tick. Anything dropped on a full queue is made
+   good by forcing a key on the next tick. */
+void spectate_tick(SpecStream *st, const Game *g) {
+    static const SpecState zero;
+    if (!st->active) return;
+    Uint32 tick = st->tick++;
+    const Board *bd = &g->board;
+    int key = st->force_key || tick - st->last_key >= (Uint32)(SPEC_KEY_SECONDS * sim_tick_hz);
+    if ((key || bd->serial != st->sent_serial) && !spec_send_board(st, bd)) {
+        st->force_key = 1;
+        st->dropped++;
+        return;
+    }
+
+    int deaths = 0;
+    int words = (bd->rows * bd->cols + 63) / 64;
+    for (int w = 0; w < words && deaths < SPEC_DEATHS_MAX; w++) {
+        Uint64 gone = st->sent_alive[w] & ~bd->alive[w];
+        for (; gone && deaths < SPEC_DEATHS_MAX; gone &= gone - 1) 
+            st->deaths[deaths++] = (Uint32)(w * 64 + ctz64(gone));
+    }
+
+    SpecState *now = &st->scratch;
+    spec_capture(now, g, tick);
+    BitBuf b;
+    SpecPacket *p = spec_begin(st, &b);
+    if (p) spec_encode(&b, key ? SPEC_KEY : SPEC_DELTA, st->seq, now, key ? &zero : &st->sent, 
+                       bd->serial, st->deaths, deaths);
+    if (!p || !spec_commit(st, p, &b)) {
+        st->force_key = 1;
+        st->dropped++;
+        return;
+    }
+    for (int i = 0; i < deaths; i++) 
+        st->sent_alive[st->deaths[i] >> 6] &= ~(1ull << (st->deaths[i] & 63));
+    st->sent = *now;
+    if (key) {
+        st->last_key = tick;
+        st->force_key = 0;
+    }
+}
+
+void spectate_close(SpecStream *st) {
+    if (!st->active) return;
+    SDL_AtomicSet(&st->quit, 1);
+    SDL_SemPost(st->wake);
+    SDL_WaitThread(st->thread, NULL);
+    SDL_DestroySemaphore(st->wake);
+    spec_link_close(&st->link);
+    double secs = st->tick ? (double)st->tick / sim_tick_hz : 0;
+    fprintf(stderr, "spectate: %llu packets, %.1f KB, %.0f B/s over %.0fs, %llu dropped\n", 
+            (unsigned long long)st->packets, st->bytes / 1024.0, secs > 0 ? st->bytes / secs : 0.0, secs, 
+            (unsigned long long)st->dropped);
+    st->active = 0;
+}
+
+/* ========================================================================
+   START: COMPONENT 1 - GAME ENGINE & LOGIC CORE (Member 1 & 2)
+   ======================================================================== */
+/* Ball, paddle and brick physics, level layout and particles live in
+   arkanoid_core.h; this build supplies the hooks below (see sdl_backend). */
+/* ======================================================================== 
+   END: COMPONENT 1 - GAME ENGINE & LOGIC CORE
+   ======================================================================== */
+
+/* ========================================================================
+   START: COMPONENT 4 - LEVELS, SCORING & PROGRESSION (Member 7 & 8)
+   ======================================================================== */
+/* One finished game, appended raw to scores.log. check guards against a
+   torn tail record left by a crash mid-append. */
+typedef struct {
+    Sint32 score;
+    Uint32 day;             /* days since 1970-01-01 UTC */
+    Uint16 level;           /* level reached */
+    char initials[4];       /* three letters + NUL */
+    Uint16 check;           /* Fletcher-16 of the preceding 14 bytes */
+} ScoreRecord;
+
+typedef char score_record_is_16_bytes[sizeof(ScoreRecord) == 16 ? 1 : -1];
+
+static Uint16 score_record_check(const ScoreRecord *r) {
+    const Uint8 *p = (const Uint8 *)r;
+    Uint16 a = 0, b = 0;
+    for (int i = 0; i < 14; i++) { 
+        a = (Uint16)((a + p[i]) % 255); 
+        b = (Uint16)((b + a) % 255); 
+    }
+    return (Uint16)((b << 8) | a);
+}
+
+/* Write-behind persistence: save_highscore and persist_record hand their
+   data to the store thread, so the game thread never blocks on the disk.
+   Requests made before the thread wakes coalesce into one commit. The high
+   score is written to "<name>.tmp", flushed, then renamed over the
+   original, so a crash leaves the old or the new file and never a torn
+   one. Leaderboard records are appended to scores.log, never rewritten.
+   Every SCORES_SNAPSHOT_EVERY records the game also hands over its
+   compacted leaderboard, which is written the same way to scores.snap
+   together with the log length it covers, so a load reads the snapshot
+   and only the log tail past it. */
+#define PERSIST_HIGHSCORE 1u
+#define PERSIST_RECORDS 2u
+#define PERSIST_SNAPSHOT 4u
+#define PERSIST_MAX_RECORDS 256
+#define SCORES_SNAPSHOT_EVERY 256
+#define SCORES_SNAPSHOT_MAGIC 0x534B5241u   /* "ARKS" */
+
+typedef struct {
+    Uint32 magic;
+    Uint32 count;               /* ScoreRecords that follow */
+    Uint64 log_end;             /* scores.log bytes folded in; loads replay from here */
+} ScoreSnapshotHeader;
+
+/* A compacted leaderboard on its way to disk. Records queued at index
+   from and later were not in the game's board when it was taken, so they
+   are folded in when it is written. */
+typedef struct {
+    ScoreRecord *records;
+    int count, from;
+} ScoreSnapshot;
+
+typedef struct {
+    SDL_mutex *lock;
+    SDL_cond *wake;
+    SDL_Thread *thread;
+    int quit;
+    Uint32 dirty;               /* PERSIST_* bits waiting for a commit */
+    int high_score;
+    ScoreRecord records[PERSIST_MAX_RECORDS];
+    int record_count;
+    ScoreSnapshot snap;         /* owned here until the thread takes it */
+} ScoreStore;
+
+ScoreStore score_store;
+
+static int write_file_atomic(const char *path, const void *data, size_t size) {
+    char tmp[256];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return 0;
+    int ok = fwrite(data, size, 1, f) == 1 && fflush(f) == 0;
+#ifndef _WIN32
+    if (ok) ok = fsync(fileno(f)) == 0;
+#endif
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) { 
+        remove(tmp); 
+        return 0; 
+    }
+#ifdef _WIN32
+    return MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(tmp, path) == 0;
+#endif
+}
+
+/* Appends whole records. A torn record left by an earlier crash is padded
+   out so later records stay aligned; its check then fails on load. */
+static int append_score_records(const ScoreRecord *recs, int n) {
+    if (n <= 0) return 1;
+    FILE *f = fopen(SCORES_LOG_FILE, "ab");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long tail = ftell(f) % (long)sizeof(ScoreRecord);
+    static const Uint8 zeros[sizeof(ScoreRecord)];
+    int ok = tail <= 0 || fwrite(zeros, (size_t)(sizeof(ScoreRecord) - tail), 1, f) == 1;
+    ok = ok && fwrite(recs, sizeof(ScoreRecord), (size_t)n, f) == (size_t)n && fflush(f) == 0;
+#ifndef _WIN32
+    if (ok) ok = fsync(fileno(f)) == 0;
+#endif
+    if (fclose(f) != 0) ok = 0;
+    return ok;
+}
+
+/* Stamped with the log's current end, so call it only after this commit's
+   appends. A torn tail has no record boundary to stamp; the next append
+   pads it and the next snapshot goes through. */
+static int write_score_snapshot(const ScoreSnapshot *snap, const ScoreRecord *extra, int n_extra) {
+    long end = 0;
+    FILE *f = fopen(SCORES_LOG_FILE, "rb");
+    if (f) {
+        if (fseek(f, 0, SEEK_END) == 0) end = ftell(f);
+        fclose(f);
+    }
+    if (end < 0 || end % (long)sizeof(ScoreRecord)) return 0;
+    size_t n = (size_t)snap->count + (size_t)n_extra;
+    Uint8 *buf = (Uint8 *)malloc(sizeof(ScoreSnapshotHeader) + n * sizeof(ScoreRecord));
+    if (!buf) return 0;
+    ScoreSnapshotHeader h = { SCORES_SNAPSHOT_MAGIC, (Uint32)n, (Uint64)end };
+    memcpy(buf, &h, sizeof(h));
+    memcpy(buf + sizeof(h), snap->records, sizeof(ScoreRecord) * (size_t)snap->count);
+    if (n_extra > 0) 
+        memcpy(buf + sizeof(h) + sizeof(ScoreRecord) * (size_t)snap->count, extra, sizeof(ScoreRecord) * (size_t)n_extra);
+    int ok = write_file_atomic(SCORES_SNAPSHOT_FILE, buf, sizeof(h) + n * sizeof(ScoreRecord));
+    free(buf);
+    return ok;
+}
+
+static void persist_commit(Uint32 dirty, int high_score, const ScoreRecord *recs, int n, 
+                           const ScoreSnapshot *snap) {
+    if (dirty & PERSIST_HIGHSCORE) 
+        write_file_atomic(HIGH_SCORE_FILE, &high_score, sizeof(int));
+    int logged = 1;
+    if (dirty & PERSIST_RECORDS) 
+        logged = append_score_records(recs, n);
+    /* after a failed append the log end is unknown; the next snapshot retries */
+    if ((dirty & PERSIST_SNAPSHOT) && logged) 
+        write_score_snapshot(snap, recs + snap->from, (dirty & PERSIST_RECORDS) ? n - snap->from : 0);
+}
+
+static int persist_thread_main(void *arg) {
+    ScoreStore *st = (ScoreStore *)arg;
+    static ScoreRecord recs[PERSIST_MAX_RECORDS];
+    SDL_LockMutex(st->lock);
+    for (;;) {
+        while (!st->dirty && !st->quit) SDL_CondWait(st->wake, st->lock);
+        if (!st->dirty) break;   /* quit with nothing pending */
+        Uint32 dirty = st->dirty;
+        int hs = st->high_score, n = st->record_count;
+        memcpy(recs, st->records, sizeof(ScoreRecord) * (size_t)n);
+        ScoreSnapshot snap = st->snap;
+        memset(&st->snap, 0, sizeof(st->snap));
+        st->record_count = 0;
+        st->dirty = 0;
+        SDL_UnlockMutex(st->lock);
+        persist_commit(dirty, hs, recs, n, &snap);
+        free(snap.records);
+        SDL_LockMutex(st->lock);
+    }
+    SDL_UnlockMutex(st->lock);
+    return 0;
+}
+
+void persist_start(void) {
+    ScoreStore *st = &score_store;
+    memset(st, 0, sizeof(*st));
+    st->lock = SDL_CreateMutex();
+    st->wake = SDL_CreateCond();
+    if (st->lock && st->wake) st->thread = SDL_CreateThread(persist_thread_main, "persist", st);
+}
+
+/* Drains pending commits, then joins the thread. */
+void persist_stop(void) {
+    ScoreStore *st = &score_store;
+    if (st->thread) {
+        SDL_LockMutex(st->lock);
+        st->quit = 1;
+        SDL_CondSignal(st->wake);
+        SDL_UnlockMutex(st->lock);
+        SDL_WaitThread(st->thread, NULL);
+    }
+    if (st->wake) SDL_DestroyCond(st->wake);
+    if (st->lock) SDL_DestroyMutex(st->lock);
+    free(st->snap.records);
+    memset(st, 0, sizeof(*st));
+}
+
+static void persist_high_score(int high_score) {
+    ScoreStore *st = &score_store;
+    if (!st->thread) {   /* no store thread: commit inline */
+        persist_commit(PERSIST_HIGHSCORE, high_score, NULL, 0, NULL);
+        return;
+    }
+    SDL_LockMutex(st->lock);
+    st->high_score = high_score;
+    st->dirty |= PERSIST_HIGHSCORE;
+    SDL_CondSignal(st->wake);
+    SDL_UnlockMutex(st->lock);
+}
+
+static void persist_record(const ScoreRecord *rec) {
+    ScoreStore *st = &score_store;
+    if (!st->thread) { 
+        persist_commit(PERSIST_RECORDS, 0, rec, 1, NULL); 
+        return; 
+    }
+    SDL_LockMutex(st->lock);
+    if (st->record_count < PERSIST_MAX_RECORDS) st->records[st->record_count++] = *rec;
+    else fprintf(stderr, "score store backlog full, dropping a record\n");
+    st->dirty |= PERSIST_RECORDS;
+    SDL_CondSignal(st->wake);
+    SDL_UnlockMutex(st->lock);
+}
+
+/* Takes a copy of the compacted records; a newer snapshot replaces one
+   the thread has not written yet. */
+static void persist_snapshot(const ScoreRecord *recs, int n) {
+    ScoreStore *st = &score_store;
+    ScoreSnapshot snap = { (ScoreRecord *)malloc(sizeof(ScoreRecord) * (size_t)(n > 0 ? n : 1)), n, 0 };
+    if (!snap.records) return;
+    memcpy(snap.records, recs, sizeof(ScoreRecord) * (size_t)n);
+    if (!st->thread) { 
+        persist_commit(PERSIST_SNAPSHOT, 0, NULL, 0, &snap); 
+        free(snap.records);
+        return; 
+    }
+    SDL_LockMutex(st->lock);
+    free(st->snap.records);
+    snap.from = st->record_count;
+    st->snap = snap;
+    st->dirty |= PERSIST_SNAPSHOT;
+    SDL_CondSignal(st->wake);
+    SDL_UnlockMutex(st->lock);
+}
+
+static void load_highscore(Game *g) {
+    FILE *f = fopen(HIGH_SCORE_FILE, "rb");
+    if (!f) { g->high_score = 0; return; }
+    int sc = 0;
+    if (fread(&sc, sizeof(int), 1, f) == 1) g->high_score = sc;
+    else g->high_score = 0;
+    fclose(f);
+}
+
+static void save_highscore(Game *g) {
+    if (g->headless || replay.mode == REPLAY_PLAY) return;
+    persist_high_score(g->high_score);
+}
+
+/* LEADERBOARD: finished games are kept in memory and indexed by top-K
+   tables: all time, per day, per player initials and per level reached.
+   Records no table holds any more are dropped when a snapshot compacts
+   the board.
+   Each table is a bounded min-heap of record ids with the weakest entry at
+   the root, so insertion is O(log K) and a full table evicts in O(log K).
+   The descending order a page read needs is rebuilt lazily, only after the
+   table changed. Tables live in an open-addressed hash keyed by kind+key. */
+#define LB_TOP_K 1024
+
+typedef enum { LB_ALL, LB_DAY, LB_PLAYER, LB_LEVEL } LbKind;
+
+typedef struct {
+    Uint32 kind, key;
+    Uint32 *heap;               /* record ids; NULL marks an empty hash slot */
+    int count, cap;
+    Uint32 *sorted;             /* descending copy of heap, valid if sorted_valid */
+    int sorted_valid;
+} LbTable;
+
+typedef struct {
+    ScoreRecord *records;
+    int count, capacity;
+    LbTable *tables;
+    int table_count, table_cap; /* table_cap is a power of two */
+    int unsnapped;              /* records logged since the last snapshot */
+} Leaderboard;
+
+Leaderboard leaderboard;
+char player_initials[4] = "PLR";   /* --player ABC */
+
+static Uint32 initials_key(const char *s) {
+    return (Uint32)(Uint8)s[0] | ((Uint32)(Uint8)s[1] << 8) | ((Uint32)(Uint8)s[2] << 16);
+}
+
+static Uint32 today_utc(void) { 
+    return (Uint32)(time(NULL) / 86400); 
+}
+
+/* heap order: lower score is weaker; on a tie the newer record is weaker */
+static int lb_weaker(const Leaderboard *lb, Uint32 a, Uint32 b) {
+    Sint32 sa = lb->records[a].score, sb = lb->records[b].score;
+    return sa < sb || (sa == sb && a > b);
+}
+
+static void lb_sift_down(const Leaderboard *lb, Uint32 *h, int n, int i) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && lb_weaker(lb, h[l], h[m])) m = l;
+        if (r < n && lb_weaker(lb, h[r], h[m])) m = r;
+        if (m == i) return;
+        Uint32 t = h[i]; h[i] = h[m]; h[m] = t;
+        i = m;
+    }
+}
+
+/* probe for kind+key; returns the matching slot or the empty one ending the run */
+static LbTable *lb_slot(Leaderboard *lb, Uint32 kind, Uint32 key) {
+    Uint32 mask = (Uint32)lb->table_cap - 1;
+    Uint32 h = (key * 2654435761u) ^ (kind * 0x9E3779B9u);
+    for (;;) {
+        LbTable *t = &lb->tables[h & mask];
+        if (!t->heap || (t->kind == kind && t->key == key)) return t;
+        h++;
+    }
+}
+
+static int lb_grow_tables(Leaderboard *lb) {
+    int old_cap = lb->table_cap;
+    LbTable *old = lb->tables;
+    int cap = old_cap ? old_cap * 2 : 64;
+    LbTable *nt = (LbTable *)calloc((size_t)cap, sizeof(LbTable));
+    if (!nt) return 0;
+    lb->tables = nt; 
+    lb->table_cap = cap; 
+    lb->table_count = 0;
+    for (int i = 0; i < old_cap; i++) {
+        if (!old[i].heap) continue;
+        *lb_slot(lb, old[i].kind, old[i].key) = old[i];
+        lb->table_count++;
+    }
+    free(old);
+    return 1;
+}
+
+static LbTable *lb_table(Leaderboard *lb, Uint32 kind, Uint32 key, int create) {
+    if (create && (lb->table_count + 1) * 10 > lb->table_cap * 7 && !lb_grow_tables(lb)) return NULL;
+    if (!lb->table_cap) return NULL;
+    LbTable *t = lb_slot(lb, kind, key);
+    if (t->heap) return t;
+    if (!create) return NULL;
+    memset(t, 0, sizeof(*t));
+    t->kind = kind; 
+    t->key = key;
+    t->cap = 16;
+    t->heap = (Uint32 *)malloc(sizeof(Uint32) * (size_t)t->cap);
+    if (!t->heap) return NULL;
+    lb->table_count++;
+    return t;
+}
+
+static void lb_table_insert(Leaderboard *lb, LbTable *t, Uint32 id) {
+    if (!t) return;
+    if (t->count < LB_TOP_K) {
+        if (t->count == t->cap) {
+            int cap = t->cap * 2 > LB_TOP_K ? LB_TOP_K : t->cap * 2;
+            Uint32 *nh = (Uint32 *)realloc(t->heap, sizeof(Uint32) * (size_t)cap);
+            if (!nh) return;
+            t->heap = nh; 
+            t->cap = cap;
+        }
+        int i = t->count++;
+        t->heap[i] = id;
+        while (i > 0 && lb_weaker(lb, t->heap[i], t->heap[(i - 1) / 2])) {
+            Uint32 tmp = t->heap[i]; t->heap[i] = t->heap[(i - 1) / 2]; t->heap[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+    } else if (lb_weaker(lb, t->heap[0], id)) {
+        t->heap[0] = id;
+        lb_sift_down(lb, t->heap, t->count, 0);
+    } else {
+        return;
+    }
+    t->sorted_valid = 0;
+}
+
+int lb_insert(Leaderboard *lb, const ScoreRecord *rec) {
+    if (lb->count == lb->capacity) {
+        int cap = lb->capacity ? lb->capacity * 2 : 256;
+        ScoreRecord *nr = (ScoreRecord *)realloc(lb->records, sizeof(ScoreRecord) * (size_t)cap);
+        if (!nr) return 0;
+        lb->records = nr; 
+        lb->capacity = cap;
+    }
+    Uint32 id = (Uint32)lb->count++;
+    lb->records[id] = *rec;
+    lb_table_insert(lb, lb_table(lb, LB_ALL, 0, 1), id);
+    lb_table_insert(lb, lb_table(lb, LB_DAY, rec->day, 1), id);
+    lb_table_insert(lb, lb_table(lb, LB_PLAYER, initials_key(rec->initials), 1), id);
+    lb_table_insert(lb, lb_table(lb, LB_LEVEL, rec->level, 1), id);
+    return 1;
+}
+
+/* Paged read, best first. Returns the rows written and, via total, the table size. */
+int lb_page(Leaderboard *lb, LbKind kind, Uint32 key, int page, int per_page, 
+            const ScoreRecord **out, int *total) {
+    LbTable *t = lb_table(lb, kind, key, 0);
+    *total = t ? t->count : 0;
+    if (!t) return 0;
+    if (!t->sorted_valid) {
+        Uint32 *s = (Uint32 *)realloc(t->sorted, sizeof(Uint32) * (size_t)t->cap);
+        if (!s) return 0;
+        t->sorted = s;
+        /* heapsort a copy: popping the weakest fills from the back */
+        memcpy(s, t->heap, sizeof(Uint32) * (size_t)t->count);
+        for (int n = t->count; n > 1; n--) {
+            Uint32 tmp = s[0]; s[0] = s[n - 1]; s[n - 1] = tmp;
+            lb_sift_down(lb, s, n - 1, 0);
+        }
+        t->sorted_valid = 1;
+    }
+    int first = page * per_page, n = 0;
+    for (int i = first; i < t->count && n < per_page; i++) out[n++] = &lb->records[t->sorted[i]];
+    return n;
+}
+
+void lb_free(Leaderboard *lb) {
+    for (int i = 0; i < lb->table_cap; i++) { 
+        free(lb->tables[i].heap); 
+        free(lb->tables[i].sorted); 
+    }
+    free(lb->tables);
+    free(lb->records);
+    memset(lb, 0, sizeof(*lb));
+}
+
+/* Rebuilds the board from the records some table still holds, in their
+   original order so score ties break the same way. A record evicted from
+   one table is weaker than everything that table holds, so the rebuilt
+   tables are the same top-K sets. */
+static int lb_compact(Leaderboard *lb) {
+    Uint8 *keep = (Uint8 *)calloc((size_t)(lb->count > 0 ? lb->count : 1), 1);
+    if (!keep) return 0;
+    for (int i = 0; i < lb->table_cap; i++) 
+        for (int k = 0; lb->tables[i].heap && k < lb->tables[i].count; k++) 
+            keep[lb->tables[i].heap[k]] = 1;
+    Leaderboard nb;
+    memset(&nb, 0, sizeof(nb));
+    for (int i = 0; i < lb->count; i++) {
+        if (keep[i] && !lb_insert(&nb, &lb->records[i])) { 
+            lb_free(&nb); 
+            free(keep); 
+            return 0; 
+        }
+    }
+    free(keep);
+    nb.unsnapped = lb->unsnapped;
+    lb_free(lb);
+    *lb = nb;
+    return 1;
+}
+
+static void leaderboard_snapshot(Leaderboard *lb) {
+    if (!lb_compact(lb)) return;
+    persist_snapshot(lb->records, lb->count);
+    lb->unsnapped = 0;
+}
+
+/* Loads scores.snap into lb and returns the log offset it covers, or 0
+   with lb left empty when there is no usable snapshot. */
+static long load_score_snapshot(Leaderboard *lb) {
+    FILE *f = fopen(SCORES_SNAPSHOT_FILE, "rb");
+    if (!f) return 0;
+    ScoreSnapshotHeader h;
+    ScoreRecord *recs = NULL;
+    int ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == SCORES_SNAPSHOT_MAGIC 
+             && h.log_end % sizeof(ScoreRecord) == 0 && h.log_end <= (Uint64)LONG_MAX;
+    if (ok && h.count > 0) {
+        recs = (ScoreRecord *)malloc(sizeof(ScoreRecord) * (size_t)h.count);
+        ok = recs && fread(recs, sizeof(ScoreRecord), h.count, f) == h.count;
+    }
+    fclose(f);
+    for (Uint32 i = 0; ok && i < h.count; i++) 
+        if (recs[i].check == score_record_check(&recs[i])) ok = lb_insert(lb, &recs[i]);
+    free(recs);
+    if (!ok) { 
+        lb_free(lb); 
+        return 0; 
+    }
+    return (long)h.log_end;
+}
+
+/* Reads scores.snap, then only the scores.log tail past it; records
+   failing their check (a torn tail) are skipped. A log shorter than the
+   snapshot's offset was replaced, so the snapshot is stale and the whole
+   log is read. First run imports the old five-entry leaderboard.dat into
+   the log. */
+static void load_leaderboard(Leaderboard *lb) {
+    long from = load_score_snapshot(lb);
+    FILE *f = fopen(SCORES_LOG_FILE, "rb");
+    if (f) {
+        long end = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+        if (end < from || fseek(f, from, SEEK_SET) != 0) { 
+            lb_free(lb); 
+            rewind(f); 
+        }
+        ScoreRecord buf[256];
+        size_t n;
+        while ((n = fread(buf, sizeof(ScoreRecord), 256, f)) > 0) 
+            for (size_t i = 0; i < n; i++) 
+                if (buf[i].check == score_record_check(&buf[i]) && lb_insert(lb, &buf[i])) lb->unsnapped++;
+        fclose(f);
+        return;
+    }
+    lb_free(lb);
+    f = fopen(LEADERBOARD_FILE, "rb");
+    if (!f) return;
+    int old[LEADERBOARD_N];
+    size_t r = fread(old, sizeof(int), LEADERBOARD_N, f);
+    fclose(f);
+    ScoreRecord imported[LEADERBOARD_N];
+    int n = 0;
+    for (size_t i = 0; i < r; i++) {
+        if (old[i] <= 0) continue;
+        ScoreRecord *rec = &imported[n++];
+        memset(rec, 0, sizeof(*rec));
+        rec->score = old[i];
+        memcpy(rec->initials, "---", 4);
+        rec->check = score_record_check(rec);
+        lb_insert(lb, rec);
+    }
+    append_score_records(imported, n);
+}
+
+static void add_to_leaderboard(Game *g, int score) {
+    if (g->headless || replay.mode == REPLAY_PLAY || score <= 0) return;
+    ScoreRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.score = score;
+    rec.day = today_utc();
+    rec.level = (Uint16)(g->game_state.level > MAX_LEVELS ? MAX_LEVELS : g->game_state.level);
+    memcpy(rec.initials, player_initials, 4);
+    rec.check = score_record_check(&rec);
+    lb_insert(&leaderboard, &rec);
+    /* until the scores load, the log may still be being read; assets_publish
+       logs what was held back */
+    if (!assets_ready) return;
+    persist_record(&rec);
+    if (++leaderboard.unsnapped >= SCORES_SNAPSHOT_EVERY) leaderboard_snapshot(&leaderboard);
+}
+
+/* Core game_over hook: the run ended, lost or won. */
+static void sdl_game_over(void *user, Game *g) {
+    (void)user;
+    if (g->game_state.score > g->high_score) { 
+        g->high_score = g->game_state.score; 
+        save_highscore(g); 
+    }
+    add_to_leaderboard(g, g->game_state.score);
+}
+
+
+/* One line of a level file without its line ending, truncated to the
+   buffer; -1 at end of file. */
+static int read_level_line(FILE *f, char *line, int size) {
+    if (!fgets(line, size, f)) return -1;
+    int len = (int)strlen(line);
+    if (len > 0 && line[len - 1] != '\n' && !feof(f)) {
+        int ch;
+        while ((ch = fgetc(f)) != EOF && ch != '\n') {}
+    }
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = 0;
+    return len;
+}
+
+/* A level file is a grid of '#' (brick), 'A' (special) and anything else
+   for empty. The board is as large as the file, but never smaller than
+   the default BRICK_ROWS x BRICK_COLUMNS so the classic levels keep their
+   look; short lines and missing rows are empty. */
+static void parse_level_text(FILE *f, Uint8 *cells, int *rows, int *cols) {
+    char line[BOARD_MAX_COLS + 3];
+    int nr = BRICK_ROWS, nc = BRICK_COLUMNS, len;
+    for (int r = 0; (len = read_level_line(f, line, sizeof(line))) >= 0; r++) {
+        if (len > 0 && r < BOARD_MAX_ROWS && r >= nr) nr = r + 1;
+        if (len > nc) nc = len < BOARD_MAX_COLS ? len : BOARD_MAX_COLS;
+    }
+    rewind(f);
+    for (int r = 0; r < nr; r++) {
+        len = read_level_line(f, line, sizeof(line));
+        for (int c = 0; c < nc; c++) {
+            char ch = (c < len) ? line[c] : '.';
+            int type = ch == '#' ? LEVEL_CELL_BRICK : ch == 'A' ? LEVEL_CELL_SPECIAL : LEVEL_CELL_EMPTY;
+            cells[r * nc + c] = (Uint8)(type | (LEVEL_COLOR_DEFAULT << 4));
+        }
+    }
+    *rows = nr; 
+    *cols = nc;
+}
+
+
+/* Binary level pack, compiled from the levelN.txt files by --compile-levels
+   and mapped read-only at startup. Little-endian layout:
+     header  "ARKL", u16 version, u16 level count, u32 0
+     index   per level: u32 cell offset (0 = not in pack), u32 alive count,
+             u16 rows, u16 cols (up to BOARD_MAX_ROWS x BOARD_MAX_COLS)
+     cells   rows * cols bytes per level
+   reset_level decodes from the mapping and hints the kernel to read the
+   next level ahead, so a level change does no blocking file I/O. */
+#define LEVEL_PACK_FILE "levels.pak"
+#define LEVEL_PACK_VERSION 2
+#define LEVEL_PACK_HEADER 12
+#define LEVEL_PACK_ENTRY 12
+
+typedef struct {
+    const Uint8 *data;
+    size_t size;
+    int levels;
+#ifdef _WIN32
+    HANDLE file, mapping;
+#endif
+} LevelPack;
+
+LevelPack level_pack;
+
+static Uint32 read_u32le(const Uint8 *p) { 
+    return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24); 
+}
+static Uint16 read_u16le(const Uint8 *p) { 
+    return (Uint16)(p[0] | (p[1] << 8)); 
+}
+
+static const Uint8 *level_pack_cells(int level, int *rows, int *cols) {
+    const LevelPack *lp = &level_pack;
+    if (!lp->data || level < 1 || level > lp->levels) return NULL;
+    const Uint8 *e = lp->data + LEVEL_PACK_HEADER + (level - 1) * LEVEL_PACK_ENTRY;
+    Uint32 off = read_u32le(e);
+    int nr = read_u16le(e + 8), nc = read_u16le(e + 10);
+    if (off == 0 || nr < 1 || nc < 1 || nr > BOARD_MAX_ROWS || nc > BOARD_MAX_COLS || 
+        (size_t)off + (size_t)nr * nc > lp->size) return NULL;
+    *rows = nr; 
+    *cols = nc;
+    return lp->data + off;
+}
+
+static void level_pack_prefetch(int level) {
+    int rows, cols;
+    const Uint8 *cells = level_pack_cells(level, &rows, &cols);
+    if (!cells) return;
+    size_t len = (size_t)rows * cols;
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    WIN32_MEMORY_RANGE_ENTRY range = { (PVOID)cells, len };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+    long page = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)cells & ~(uintptr_t)(page - 1);
+    posix_madvise((void *)start, (uintptr_t)cells + len - start, POSIX_MADV_WILLNEED);
+#endif
+}
+
+void level_pack_close(void) {
+    LevelPack *lp = &level_pack;
+#ifdef _WIN32
+    if (lp->data) UnmapViewOfFile(lp->data);
+    if (lp->mapping) CloseHandle(lp->mapping);
+    if (lp->file && lp->file != INVALID_HANDLE_VALUE) CloseHandle(lp->file);
+#else
+    if (lp->data) munmap((void *)lp->data, lp->size);
+#endif
+    memset(lp, 0, sizeof(*lp));
+}
+
+/* Maps the pack if present and valid; otherwise levels fall back to the text files. */
+int level_pack_open(const char *path) {
+    LevelPack *lp = &level_pack;
+    memset(lp, 0, sizeof(*lp));
+#ifdef _WIN32
+    lp->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (lp->file == INVALID_HANDLE_VALUE) { lp->file = NULL; return 0; }
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(lp->file, &sz) || sz.QuadPart < LEVEL_PACK_HEADER) { level_pack_close(); return 0; }
+    lp->mapping = CreateFileMappingA(lp->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!lp->mapping) { level_pack_close(); return 0; }
+    lp->data = (const Uint8 *)MapViewOfFile(lp->mapping, FILE_MAP_READ, 0, 0, 0);
+    lp->size = (size_t)sz.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < LEVEL_PACK_HEADER) { close(fd); return 0; }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return 0;
+    lp->data = (const Uint8 *)p;
+    lp->size = (size_t)st.st_size;
+#endif
+    if (!lp->data) { level_pack_close(); return 0; }
+    const Uint8 *h = lp->data;
+    int levels = read_u16le(h + 6);
+    if (memcmp(h, "ARKL", 4) != 0 || read_u16le(h + 4) != LEVEL_PACK_VERSION || 
+        lp->size < (size_t)LEVEL_PACK_HEADER + (size_t)levels * LEVEL_PACK_ENTRY) {
+        fprintf(stderr, "%s: not a version %d level pack, ignoring (rebuild with --compile-levels)\n", 
+                path, LEVEL_PACK_VERSION);
+        level_pack_close();
+        return 0;
+    }
+    lp->levels = levels;
+    level_pack_prefetch(1);
+    return 1;
+}
+
+static void put_u32le(Uint8 *p, Uint32 v) { 
+    p[0] = (Uint8)v; p[1] = (Uint8)(v >> 8); p[2] = (Uint8)(v >> 16); p[3] = (Uint8)(v >> 24); 
+}
+
+static void put_u16le(Uint8 *p, Uint16 v) { 
+    p[0] = (Uint8)v; p[1] = (Uint8)(v >> 8); 
+}
+
+/* Level compiler: levelN.txt for N = 1..MAX_LEVELS into one pack. Each
+   level keeps the grid size of its file. The index is written last, once
+   every level's offset is known. */
+int compile_level_pack(const char *out_path) {
+    Uint8 header[LEVEL_PACK_HEADER + MAX_LEVELS * LEVEL_PACK_ENTRY];
+    static Uint8 cells[BOARD_MAX_CELLS];
+    int found = 0;
+    memset(header, 0, sizeof(header));
+    memcpy(header, "ARKL", 4);
+    header[4] = LEVEL_PACK_VERSION; 
+    header[6] = MAX_LEVELS;
+    FILE *out = fopen(out_path, "wb");
+    if (!out) { 
+        fprintf(stderr, "cannot write %s\n", out_path); 
+        return 0; 
+    }
+    int ok = fwrite(header, sizeof(header), 1, out) == 1;
+    Uint32 off = sizeof(header);
+    for (int lv = 1; lv <= MAX_LEVELS && ok; lv++) {
+        char name[128];
+        snprintf(name, sizeof(name), "level%d.txt", lv);
+        FILE *f = fopen(name, "r");
+        if (!f) continue;
+        int rows, cols;
+        parse_level_text(f, cells, &rows, &cols);
+        fclose(f);
+        int n = rows * cols, alive = 0;
+        for (int i = 0; i < n; i++) alive += (cells[i] & 3) != LEVEL_CELL_EMPTY;
+        Uint8 *e = header + LEVEL_PACK_HEADER + (lv - 1) * LEVEL_PACK_ENTRY;
+        put_u32le(e, off); 
+        put_u32le(e + 4, (Uint32)alive);
+        put_u16le(e + 8, (Uint16)rows); 
+        put_u16le(e + 10, (Uint16)cols);
+        ok = fwrite(cells, (size_t)n, 1, out) == 1;
+        off += (Uint32)n;
+        found++;
+    }
+    if (ok) ok = fseek(out, 0, SEEK_SET) == 0 && fwrite(header, sizeof(header), 1, out) == 1;
+    if (fclose(out) != 0) ok = 0;
+    fprintf(stderr, "%s: %d of %d levels packed (%u bytes)\n", out_path, found, MAX_LEVELS, (unsigned)off);
+    return ok;
+}
+
+/* Core level_cells hook: the pack first, then levelN.txt, else NULL for
+   the built-in layout. */
+static const Uint8 *sdl_level_cells(void *user, int level, Uint8 *scratch, int *rows, int *cols) {
+    (void)user;
+    const Uint8 *packed = level_pack_cells(level, rows, cols);
+    if (packed) {
+        level_pack_prefetch(level + 1);
+        return packed;
+    }
+    char name[128]; 
+    snprintf(name, sizeof(name), "level%d.txt", level);
+    FILE *f = fopen(name, "r");
+    if (!f) return NULL;
+    parse_level_text(f, scratch, rows, cols);
+    fclose(f);
+    return scratch;
+}
+
+/* ======================================================================== 
+   END: COMPONENT 4 - LEVELS, SCORING & PROGRESSION
+   ======================================================================== */
+
+/* ========================================================================
+   START: COMPONENT 2 - GRAPHICS & RENDERING (Member 3 & 4)
+   ======================================================================== */
+/* Render batching: fills are queued as colored quads and submitted with one
+   SDL_RenderGeometry call per blend-mode run instead of a SetRenderDrawColor
+   + FillRect pair each. Drawing order is preserved, so callers use the
+   batch_* calls exactly like the SDL calls they replace. */
+typedef struct { float x, y, w, h; SDL_Color col; int cell; } BatchQuad;
+
+typedef struct {
+    BatchQuad *quads;
+    int count, capacity;
+    SDL_Color color;
+    SDL_BlendMode blend;
+    SDL_Vertex *verts;
+    int *indices;
+    int vert_capacity;
+} QuadBatch;
+
+typedef struct { int draw_calls; int quads; } RenderStats;
+
+/* Sprite atlas: one static texture holding the font glyphs and the entity
+   sprites, so fills, text and sprites all share one draw call. Cell 0 is
+   solid white so plain fills can sample it. Glyphs are rasterized at 1px
+   per font pixel and scaled up with nearest sampling, which matches the
+   old per-pixel fills exactly at every scale. Entity sprites are the very
+   fills the primitive path draws, composited once on the CPU and blitted
+   1:1 at integer positions; brick cells follow the board's brick size. */
+#define FONT_MAX_GLYPHS 64
+#define HEART_W 20
+#define HEART_H 18
+#define PADDLE_SPRITES ((WINDOW_WIDTH/2 - PADDLE_WIDTH) / PADDLE_GROW + 2)
+#define BRICK_SPRITE_W ((int)(BRICK_WIDTH - BRICK_PADDING))
+#define BRICK_SPRITE_H ((int)(BRICK_HEIGHT - BRICK_PADDING))
+enum {
+    ATLAS_WHITE,
+    ATLAS_GLOW,                                     /* ball and glow, per quality tier */
+    ATLAS_PADDLE = ATLAS_GLOW + QUALITY_TIER_COUNT, /* per width bucket, widest last */
+    ATLAS_BRICK = ATLAS_PADDLE + PADDLE_SPRITES,    /* per palette color */
+    ATLAS_COLLECT = ATLAS_BRICK + 10,               /* per CollectibleType */
+    ATLAS_HEART = ATLAS_COLLECT + 2,
+    ATLAS_GLYPH,
+    ATLAS_CELLS = ATLAS_GLYPH + FONT_MAX_GLYPHS
+};
+
+typedef struct {
+    SDL_Texture *tex;
+    int w, h;
+    Uint8 *px;                  /* CPU copy (RGBA32) the brick cells are re-baked in */
+    SDL_Rect cell[ATLAS_CELLS];
+    float brick_w, brick_h;     /* board brick size the brick cells were baked for */
+    int bricks_ok;
+} SpriteAtlas;
+SpriteAtlas sprite_atlas;
+
+QuadBatch quad_batch;
+RenderStats render_stats;       /* last completed frame, readable by tools */
+RenderStats frame_stats;        /* frame being built */
+
+void batch_flush(void) {
+    QuadBatch *qb = &quad_batch;
+    if (qb->count == 0) return;
+    SDL_SetRenderDrawBlendMode(renderer, qb->blend);
+    if (sprite_atlas.tex) SDL_SetTextureBlendMode(sprite_atlas.tex, qb->blend);
+#if SDL_VERSION_ATLEAST(2,0,18)
+    if (qb->vert_capacity < qb->count) {
+        int cap = qb->capacity;
+        SDL_Vertex *v = (SDL_Vertex *)realloc(qb->verts, (size_t)cap * 4 * sizeof(SDL_Vertex));
+        int *ix = (int *)realloc(qb->indices, (size_t)cap * 6 * sizeof(int));
+        if (v) qb->verts = v;
+        if (ix) qb->indices = ix;
+        if (v && ix) {
+            for (int q = qb->vert_capacity; q < cap; q++) {
+                int *k = &ix[q * 6], b = q * 4;
+                k[0] = b; k[1] = b + 1; k[2] = b + 2; 
+                k[3] = b + 2; k[4] = b + 3; k[5] = b;
+            }
+            qb->vert_capacity = cap;
+        }
+    }
+    if (qb->vert_capacity >= qb->count) {
+        SpriteAtlas *sa = &sprite_atlas;
+        float aw = sa->w ? 1.0f / sa->w : 0, ah = sa->h ? 1.0f / sa->h : 0;
+        for (int q = 0; q < qb->count; q++) {
+            BatchQuad *bq = &qb->quads[q];
+            SDL_Vertex *v = &qb->verts[q * 4];
+            /* fills sample the middle of the white cell */
+            float u0 = 2.5f * aw, u1 = u0, v0 = 3.5f * ah, v1 = v0;
+            if (bq->cell >= 0) {
+                const SDL_Rect *c = &sa->cell[bq->cell];
+                u0 = (float)c->x * aw; 
+                u1 = (float)(c->x + c->w) * aw;
+                v0 = (float)c->y * ah; 
+                v1 = (float)(c->y + c->h) * ah;
+            }
+            v[0].position.x = bq->x;         v[0].position.y = bq->y;
+            v[1].position.x = bq->x + bq->w; v[1].position.y = bq->y;
+            v[2].position.x = bq->x + bq->w; v[2].position.y = bq->y + bq->h;
+            v[3].position.x = bq->x;         v[3].position.y = bq->y + bq->h;
+            v[0].tex_coord.x = u0; v[0].tex_coord.y = v0;
+            v[1].tex_coord.x = u1; v[1].tex_coord.y = v0;
+            v[2].tex_coord.x = u1; v[2].tex_coord.y = v1;
+            v[3].tex_coord.x = u0; v[3].tex_coord.y = v1;
+            for (int k = 0; k < 4; k++) v[k].color = bq->col; 
+        }
+        SDL_RenderGeometry(renderer, sprite_atlas.tex, qb->verts, qb->count * 4, qb->indices, qb->count * 6);
+        frame_stats.draw_calls++;
+        frame_stats.quads += qb->count;
+        qb->count = 0;
+        return;
+    }
+#endif
+    /* fallback: one FillRects per run of same-colored fills, one copy per glyph or sprite */
+    SDL_FRect run[256];
+    int n = 0;
+    for (int q = 0; q < qb->count; q++) {
+        BatchQuad *bq = &qb->quads[q];
+        SDL_FRect fr = { bq->x, bq->y, bq->w, bq->h };
+        if (bq->cell >= 0) {
+            SDL_SetTextureColorMod(sprite_atlas.tex, bq->col.r, bq->col.g, bq->col.b);
+            SDL_SetTextureAlphaMod(sprite_atlas.tex, bq->col.a);
+            SDL_RenderCopyF(renderer, sprite_atlas.tex, &sprite_atlas.cell[bq->cell], &fr);
+            frame_stats.draw_calls++;
+            continue;
+        }
+        run[n++] = fr;
+        int last = (q + 1 == qb->count) || n == 256 || qb->quads[q + 1].cell >= 0 ||
+                   memcmp(&qb->quads[q + 1].col, &bq->col, sizeof(SDL_Color)) != 0;
+        if (last) {
+            SDL_SetRenderDrawColor(renderer, bq->col.r, bq->col.g, bq->col.b, bq->col.a);
+            SDL_RenderFillRectsF(renderer, run, n);
+            frame_stats.draw_calls++;
+            n = 0;
+        }
+    }
+    frame_stats.quads += qb->count;
+    qb->count = 0;
+}
+
+void batch_begin_frame(void) {
+    memset(&frame_stats, 0, sizeof(frame_stats));
+    quad_batch.count = 0;
+    quad_batch.blend = SDL_BLENDMODE_BLEND;
+}
+
+void batch_end_frame(void) {
+    batch_flush();
+    render_stats = frame_stats;
+}
+
+void batch_free(void) {
+    free(quad_batch.quads); 
+    free(quad_batch.verts); 
+    free(quad_batch.indices);
+    memset(&quad_batch, 0, sizeof(quad_batch));
+}
+
+void batch_set_color(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    SDL_Color c = { r, g, b, a };
+    quad_batch.color = c;
+}
+
+void batch_set_blend(SDL_BlendMode mode) {
+    if (mode == quad_batch.blend) return;
+    batch_flush();
+    quad_batch.blend = mode;
+}
+
+void batch_fill_rectf(float x, float y, float w, float h) {
+    QuadBatch *qb = &quad_batch;
+    if (w <= 0 || h <= 0) return;
+    if (qb->count == qb->capacity) {
+        int cap = qb->capacity ? qb->capacity * 2 : 4096;
+        BatchQuad *nq = (BatchQuad *)realloc(qb->quads, (size_t)cap * sizeof(BatchQuad));
+        if (!nq) { 
+            batch_flush(); 
+            if (qb->capacity == 0) return; 
+        } else { 
+            qb->quads = nq; 
+            qb->capacity = cap; 
+        }
+    }
+    BatchQuad *bq = &qb->quads[qb->count++];
+    bq->x = x; bq->y = y; bq->w = w; bq->h = h; 
+    bq->col = qb->color;
+    bq->cell = -1;
+}
+
+/* one atlas cell tinted by the current color and scaled into (x, y, w, h);
+   needs sprite_atlas.tex */
+void batch_sprite(int cell, float x, float y, float w, float h) {
+    QuadBatch *qb = &quad_batch;
+    batch_fill_rectf(x, y, w, h);
+    if (qb->count > 0) qb->quads[qb->count - 1].cell = cell;
+}
+
+/* an entity sprite untinted and 1:1 at an integer position */
+void draw_sprite(int cell, int x, int y) {
+    const SDL_Rect *c = &sprite_atlas.cell[cell];
+    batch_set_color(255, 255, 255, 255);
+    batch_sprite(cell, (float)x, (float)y, (float)c->w, (float)c->h);
+}
+
+void batch_fill_rect(const SDL_Rect *r) {
+    batch_fill_rectf((float)r->x, (float)r->y, (float)r->w, (float)r->h);
+}
+
+/* 1px outline as four thin quads, matching SDL_RenderDrawRect coverage */
+void batch_outline_rect(const SDL_Rect *r) {
+    batch_fill_rectf((float)r->x, (float)r->y, (float)r->w, 1);
+    batch_fill_rectf((float)r->x, (float)(r->y + r->h - 1), (float)r->w, 1);
+    batch_fill_rectf((float)r->x, (float)(r->y + 1), 1, (float)(r->h - 2));
+    batch_fill_rectf((float)(r->x + r->w - 1), (float)(r->y + 1), 1, (float)(r->h - 2));
+}
+
+void draw_rectf(const RectF *f) { 
+    SDL_Rect rr = { (int)f->x, (int)f->y, (int)f->w, (int)f->h }; 
+    batch_fill_rect(&rr); 
+}
+
+/* Straight-alpha "over" of one fill into an atlas cell, clipped to it.
+   Composited in draw order this gives the same pixels the blended fills
+   give on screen, so a sprite blit reproduces the layered look. */
+static void atlas_fill(const SDL_Rect *cell, int x, int y, int w, int h, SDL_Color c) {
+    SpriteAtlas *sa = &sprite_atlas;
+    int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int x1 = x + w > cell->w ? cell->w : x + w, y1 = y + h > cell->h ? cell->h : y + h;
+    float s = c.a / 255.0f;
+    for (int yy = y0; yy < y1; yy++) {
+        Uint8 *d = sa->px + ((size_t)(cell->y + yy) * sa->w + cell->x + x0) * 4;
+        for (int xx = x0; xx < x1; xx++, d += 4) {
+            float da = d[3] / 255.0f * (1.0f - s), oa = s + da;
+            if (oa <= 0) continue;
+            d[0] = (Uint8)((c.r * s + d[0] * da) / oa + 0.5f);
+            d[1] = (Uint8)((c.g * s + d[1] * da) / oa + 0.5f);
+            d[2] = (Uint8)((c.b * s + d[2] * da) / oa + 0.5f);
+            d[3] = (Uint8)(oa * 255.0f + 0.5f);
+        }
+    }
+}
+
+static void atlas_clear(const SDL_Rect *cell) {
+    SpriteAtlas *sa = &sprite_atlas;
+    for (int yy = 0; yy < cell->h; yy++) 
+        memset(sa->px + ((size_t)(cell->y + yy) * sa->w + cell->x) * 4, 0, (size_t)cell->w * 4);
+}
+
+/* how far the outermost glow ring reaches past the ball on each side */
+static int glow_reach(int rings) { 
+    return rings > 0 ? (rings - 1) * 2 : 0; 
+}
+
+static int paddle_sprite_width(int k) {
+    return k == PADDLE_SPRITES - 1 ? WINDOW_WIDTH/2 : PADDLE_WIDTH + k * PADDLE_GROW;
+}
+
+/* atlas cell for a paddle width, or -1 off the pickup grid (spectator
+   views quantize it) */
+static int paddle_sprite(float w) {
+    int iw = (int)w, k = iw - PADDLE_WIDTH;
+    if ((float)iw != w || k < 0) return -1;
+    if (iw == WINDOW_WIDTH/2) return ATLAS_PADDLE + PADDLE_SPRITES - 1;
+    if (k % PADDLE_GROW || k / PADDLE_GROW >= PADDLE_SPRITES - 1) return -1;
+    return ATLAS_PADDLE + k / PADDLE_GROW;
+}
+
+/* The bakes mirror the primitive draws below with the entity at (0, 0);
+   keep the two in step when a look changes. */
+static void bake_glow(int tier) {
+    const SDL_Rect *c = &sprite_atlas.cell[ATLAS_GLOW + tier];
+    int rings = QUALITY_TIERS[tier].glow_rings, e = glow_reach(rings);
+    for (int i = rings; i >= 1; i--) {
+        float t = (float)i / (float)rings;
+        int k = (rings - i) * 2;
+        atlas_fill(c, e - k, e - k, BALL_SIZE + 2*k, BALL_SIZE + 2*k, (SDL_Color){ 255, 240, 180, (Uint8)(40 * t) });
+    }
+    atlas_fill(c, e, e, BALL_SIZE, BALL_SIZE, (SDL_Color){ 255, 240, 180, 255 });
+}
+
+static void bake_paddle(int k) {
+    const SDL_Rect *c = &sprite_atlas.cell[ATLAS_PADDLE + k];
+    atlas_fill(c, 0, 0, c->w, c->h, (SDL_Color){ 30, 90, 140, 255 });
+    atlas_fill(c, 4, 2, c->w - 8, (int)(PADDLE_HEIGHT/2.0f - 2), (SDL_Color){ 220, 240, 255, 255 });
+}
+
+static void bake_brick(int color_index, float w, float h) {
+    const SDL_Rect *c = &sprite_atlas.cell[ATLAS_BRICK + color_index];
+    atlas_fill(c, 0, 0, c->w, c->h, color_palette[color_index]);
+    atlas_fill(c, 6, 4, (int)(w * 0.5f), (int)(h * 0.35f), (SDL_Color){ 255, 255, 255, 110 });
+    atlas_fill(c, 4, (int)(h - 6), (int)(w - 6), 6, (SDL_Color){ 0, 0, 0, 40 });
+}
+
+static void bake_collectible(int type) {
+    const SDL_Rect *c = &sprite_atlas.cell[ATLAS_COLLECT + type];
+    SDL_Color edge = { 255, 255, 255, 100 };
+    atlas_fill(c, 0, 0, c->w, c->h, type == COLLECT_MULTIBALL ? (SDL_Color){ 90, 220, 255, 255 } 
+                                                              : (SDL_Color){ 255, 200, 80, 255 });
+    atlas_fill(c, 0, 0, c->w, 1, edge);
+    atlas_fill(c, 0, c->h - 1, c->w, 1, edge);
+    atlas_fill(c, 0, 1, 1, c->h - 2, edge);
+    atlas_fill(c, c->w - 1, 1, 1, c->h - 2, edge);
+}
+
+static void bake_heart(void) {
+    const SDL_Rect *c = &sprite_atlas.cell[ATLAS_HEART];
+    SDL_Color col = { 255, 80, 120, 255 };
+    atlas_fill(c, 0, 0, HEART_W/2, HEART_H/2, col);
+    atlas_fill(c, HEART_W/2, 0, HEART_W/2, HEART_H/2, col);
+    atlas_fill(c, HEART_W/4, HEART_H/4, HEART_W/2, HEART_H*3/4, col);
+}
+
+/* Re-bakes the brick cells when the board's brick size changes; boards
+   whose bricks outgrow the reserved cells, or are too small for the bevel,
+   draw them as fills. */
+void sprite_atlas_fit_bricks(const Board *bd) {
+    SpriteAtlas *sa = &sprite_atlas;
+    if (!sa->tex || (sa->brick_w == bd->brick_w && sa->brick_h == bd->brick_h)) return;
+    sa->brick_w = bd->brick_w;
+    sa->brick_h = bd->brick_h;
+    int w = (int)bd->brick_w, h = (int)bd->brick_h;
+    sa->bricks_ok = bd->brick_w >= 16 && bd->brick_h >= 12 && w <= BRICK_SPRITE_W && h <= BRICK_SPRITE_H;
+    if (!sa->bricks_ok) return;
+    batch_flush();      /* queued quads still sample the old cells */
+    for (int i = 0; i < 10; i++) {
+        SDL_Rect *c = &sa->cell[ATLAS_BRICK + i];
+        c->w = w; 
+        c->h = h;
+        atlas_clear(c);
+        bake_brick(i, bd->brick_w, bd->brick_h);
+        SDL_UpdateTexture(sa->tex, c, sa->px + ((size_t)c->y * sa->w + c->x) * 4, sa->w * 4);
+    }
+}
+
+void draw_ball_with_glow(Ball *b) {
+    const QualityTier *qt = quality_tier();
+    int rings = qt->glow_rings;
+    if (sprite_atlas.tex && b->rect.w == BALL_SIZE && b->rect.h == BALL_SIZE) {
+        int e = glow_reach(rings);
+        draw_sprite(ATLAS_GLOW + (int)(qt - QUALITY_TIERS), (int)b->rect.x - e, (int)b->rect.y - e);
+        return;
+    }
+    for (int i = rings; i >= 1; i--) {
+        float t = (float)i / (float)rings;
+        Uint8 a = (Uint8)(40 * t);
+        batch_set_color(255, 240, 180, a);
+        RectF gr = { b->rect.x - (rings-i)*2.0f, b->rect.y - (rings-i)*2.0f, 
+                     b->rect.w + (rings-i)*4.0f, b->rect.h + (rings-i)*4.0f };
+        draw_rectf(&gr);
+    }
+    batch_set_color(255, 240, 180, 255); 
+    draw_rectf(&b->rect);
+}
+
+void draw_paddle(Paddle *p) {
+    int cell = paddle_sprite(p->rect.w);
+    if (sprite_atlas.tex && cell >= 0 && p->rect.h == PADDLE_HEIGHT) {
+        draw_sprite(cell, (int)p->rect.x, (int)p->rect.y);
+        return;
+    }
+    batch_set_color(30, 90, 140, 255); 
+    draw_rectf(&p->rect);
+    batch_set_color(220, 240, 255, 255);
+    RectF top = { p->rect.x + 4, p->rect.y + 2, p->rect.w - 8, p->rect.h/2 - 2 }; 
+    draw_rectf(&top);
+}
+
+void draw_textured_brick(const RectF *r, int color_index) {
+    SDL_Color base = color_palette[color_index % 10]; 
+    batch_set_color(base.r, base.g, base.b, 255); 
+    /* mega-board bricks can be under a pixel; keep them visible and skip
+       the bevel, which needs room */
+    if (r->w < 16 || r->h < 12) {
+        RectF body = { r->x, r->y, r->w < 1 ? 1 : r->w, r->h < 1 ? 1 : r->h };
+        draw_rectf(&body);
+        return;
+    }
+    if (sprite_atlas.bricks_ok && r->w == sprite_atlas.brick_w && r->h == sprite_atlas.brick_h) {
+        draw_sprite(ATLAS_BRICK + color_index % 10, (int)r->x, (int)r->y);
+        return;
+    }
+    draw_rectf(r);
+    batch_set_color(255, 255, 255, 110); 
+    RectF shine = { r->x + 6, r->y + 4, r->w * 0.5f, r->h * 0.35f }; 
+    draw_rectf(&shine);
+    batch_set_color(0, 0, 0, 40); 
+    RectF shadow = { r->x + 4, r->y + r->h - 6, r->w - 6, 6 }; 
+    draw_rectf(&shadow);
+}
+
+/* Every live brick in the rows that fall inside the window, walked through
+   the alive mask so empty stretches of a big board cost next to nothing. */
+void draw_board(const Board *bd) {
+    RectF view = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
+    int r0, r1, c0, c1;
+    if (!brick_cells_for_rect(bd, &view, &r0, &r1, &c0, &c1)) return;
+    sprite_atlas_fit_bricks(bd);
+    int end = (r1 + 1) * bd->cols;
+    for (int i = board_next_alive(bd, r0 * bd->cols, end); i < end; i = board_next_alive(bd, i + 1, end)) {
+        RectF r = brick_rect(bd, i / bd->cols, i % bd->cols);
+        draw_textured_brick(&r, brick_color(bd, i));
+    }
+}
+
+/* The brick field lives in a persistent target texture that is rebuilt on
+   level reset and patched per cell when a brick dies, so a normal frame
+   draws it with one copy. */
+typedef struct { SDL_Texture *tex; int lost; } BrickLayer;
+BrickLayer brick_layer;
+
+void brick_layer_init(void) {
+    brick_layer.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, 
+                                        WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (brick_layer.tex) SDL_SetTextureBlendMode(brick_layer.tex, SDL_BLENDMODE_BLEND);
+    brick_layer.lost = 1;
+}
+
+void brick_layer_free(void) {
+    if (brick_layer.tex) SDL_DestroyTexture(brick_layer.tex);
+    memset(&brick_layer, 0, sizeof(brick_layer));
+}
+
+void brick_layer_invalidate(void) { 
+    brick_layer.lost = 1; 
+}
+
+void update_brick_layer(Game *g) {
+    Board *bd = &g->board;
+    int full = bd->dirty_all || brick_layer.lost;
+    if (!full && bd->dirty_count == 0) return;
+    batch_flush();
+    SDL_SetRenderTarget(renderer, brick_layer.tex);
+    if (full) {
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        draw_board(bd);
+    } else {
+        /* punch the dead bricks back to transparent */
+        batch_set_blend(SDL_BLENDMODE_NONE);
+        batch_set_color(0, 0, 0, 0);
+        for (int k = 0; k < bd->dirty_count; k++) {
+            RectF r = brick_rect(bd, (int)bd->dirty[k] / bd->cols, (int)bd->dirty[k] % bd->cols);
+            draw_rectf(&r);
+        }
+        batch_set_blend(SDL_BLENDMODE_BLEND);
+    }
+    batch_flush();
+    SDL_SetRenderTarget(renderer, NULL);
+    bd->dirty_count = 0;
+    bd->dirty_all = 0;
+    brick_layer.lost = 0;
+}
+/* ======================================================================== 
+   END: COMPONENT 2 - GRAPHICS & RENDERING
+   ======================================================================== */
+
+/* ========================================================================
+   START: COMPONENT 5 - SOUND, UI & MENU SYSTEM (Member 9 & 10)
+   ======================================================================== */
+static const unsigned char FONT_5x7[][5] = {
+    {0x3E,0x51,0x49,0x45,0x3E},{0x00,0x42,0x7F,0x40,0x00},{0x42,0x61,0x51,0x49,0x46},{0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10},{0x27,0x45,0x45,0x45,0x39},{0x3C,0x4A,0x49,0x49,0x30},{0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36},{0x06,0x49,0x49,0x29,0x1E},
+    {0x7C,0x12,0x11,0x12,0x7C},{0x7F,0x49,0x49,0x49,0x36},{0x3E,0x41,0x41,0x41,0x22},{0x7F,0x41,0x41,0x22,0x1C},
+    {0x7F,0x49,0x49,0x49,0x41},{0x7F,0x09,0x09,0x09,0x01},{0x3E,0x41,0x49,0x49,0x7A},{0x7F,0x08,0x08,0x08,0x7F},
+    {0x00,0x41,0x7F,0x41,0x00},{0x20,0x40,0x41,0x3F,0x01},{0x7F,0x08,0x14,0x22,0x41},{0x7F,0x40,0x40,0x40,0x40},
+    {0x7F,0x02,0x04,0x02,0x7F},{0x7F,0x04,0x08,0x10,0x7F},{0x3E,0x41,0x41,0x41,0x3E},{0x7F,0x09,0x09,0x09,0x06},
+    {0x3E,0x41,0x51,0x21,0x5E},{0x7F,0x09,0x19,0x29,0x46},{0x46,0x49,0x49,0x49,0x31},{0x01,0x01,0x7F,0x01,0x01},
+    {0x3F,0x40,0x40,0x40,0x3F},{0x1F,0x20,0x40,0x20,0x1F},{0x3F,0x40,0x38,0x40,0x3F},{0x63,0x14,0x08,0x14,0x63},
+    {0x07,0x08,0x70,0x08,0x07},{0x61,0x51,0x49,0x45,0x43}
+};
+
+static int char_index_for_hud(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'A' && ch <= 'Z') return 10 + (ch - 'A');
+    return -1;
+}
+
+#define FONT_GLYPHS ((int)(sizeof(FONT_5x7) / sizeof(FONT_5x7[0])))
+
+void sprite_atlas_free(void) {
+    if (sprite_atlas.tex) SDL_DestroyTexture(sprite_atlas.tex);
+    free(sprite_atlas.px);
+    memset(&sprite_atlas, 0, sizeof(sprite_atlas));
+}
+
+/* Shelf-packs every cell with a 1px gap, rasterizes glyphs and sprites
+   into the CPU copy and uploads it once. Brick cells are reserved at the
+   default brick size and baked on first use by sprite_atlas_fit_bricks. */
+int sprite_atlas_init(void) {
+    SpriteAtlas *sa = &sprite_atlas;
+    SDL_Rect *c = sa->cell;
+    c[ATLAS_WHITE] = (SDL_Rect){ 0, 0, 5, 7 };
+    for (int t = 0; t < QUALITY_TIER_COUNT; t++) {
+        int side = BALL_SIZE + 2 * glow_reach(QUALITY_TIERS[t].glow_rings);
+        c[ATLAS_GLOW + t] = (SDL_Rect){ 0, 0, side, side };
+    }
+    for (int k = 0; k < PADDLE_SPRITES; k++) 
+        c[ATLAS_PADDLE + k] = (SDL_Rect){ 0, 0, paddle_sprite_width(k), PADDLE_HEIGHT };
+    for (int i = 0; i < 10; i++) 
+        c[ATLAS_BRICK + i] = (SDL_Rect){ 0, 0, BRICK_SPRITE_W, BRICK_SPRITE_H };
+    for (int i = 0; i < 2; i++) 
+        c[ATLAS_COLLECT + i] = (SDL_Rect){ 0, 0, COLLECTIBLE_SIZE, COLLECTIBLE_SIZE };
+    c[ATLAS_HEART] = (SDL_Rect){ 0, 0, HEART_W, HEART_H };
+    for (int i = 0; i < FONT_GLYPHS; i++) 
+        c[ATLAS_GLYPH + i] = (SDL_Rect){ 0, 0, 5, 7 };
+    int w = WINDOW_WIDTH/2 > 256 ? WINDOW_WIDTH/2 : 256, x = 0, y = 0, shelf = 0;
+    for (int i = 0; i < ATLAS_GLYPH + FONT_GLYPHS; i++) {
+        if (x + c[i].w > w) { 
+            x = 0; 
+            y += shelf + 1; 
+            shelf = 0; 
+        }
+        c[i].x = x; 
+        c[i].y = y;
+        x += c[i].w + 1;
+        if (c[i].h > shelf) shelf = c[i].h;
+    }
+    int h = y + shelf;
+    sa->w = w;
+    sa->px = (Uint8 *)calloc((size_t)w * h, 4);
+    if (!sa->px) return 0;
+    SDL_Color white = { 255, 255, 255, 255 };
+    atlas_fill(&c[ATLAS_WHITE], 0, 0, 5, 7, white);
+    for (int i = 0; i < FONT_GLYPHS; i++) {
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < 7; row++) {
+                if ((FONT_5x7[i][col] >> row) & 1) 
+                    atlas_fill(&c[ATLAS_GLYPH + i], col, row, 1, 1, white);
+            }
+        }
+    }
+    for (int t = 0; t < QUALITY_TIER_COUNT; t++) bake_glow(t);
+    for (int k = 0; k < PADDLE_SPRITES; k++) bake_paddle(k);
+    for (int i = 0; i < 2; i++) bake_collectible(i);
+    bake_heart();
+    sa->tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, w, h);
+    if (sa->tex) {
+        SDL_UpdateTexture(sa->tex, NULL, sa->px, w * 4);
+        SDL_SetTextureBlendMode(sa->tex, SDL_BLENDMODE_BLEND);
+        sa->h = h;
+    } else {
+        sprite_atlas_free();
+    }
+    return sa->tex != NULL;
+}
+
+void draw_glyph(char ch, int x, int y, int scale, SDL_Color color) {
+    int idx = char_index_for_hud(ch);
+    if (idx < 0) return;
+    batch_set_color(color.r, color.g, color.b, color.a);
+    if (sprite_atlas.tex) {
+        batch_sprite(ATLAS_GLYPH + idx, (float)x, (float)y, (float)(5 * scale), (float)(7 * scale));
+        return;
+    }
+    const unsigned char *cols = FONT_5x7[idx];
+    for (int col = 0; col < 5; col++) {
+        unsigned char colbits = cols[col];
+        for (int row = 0; row < 7; row++) {
+            int bit = (colbits >> row) & 1;
+            if (bit) {
+                SDL_Rect r = { x + col * scale, y + row * scale, scale, scale };
+                batch_fill_rect(&r);
+            }
+        }
+    }
+}
+
+/* returns the number of character cells drawn */
+int draw_text_pixel(const char *s, int x, int y, int scale, SDL_Color col) {
+    int cx = x, n = 0;
+    for (; s[n]; ++n) {
+        if (s[n] != ' ') draw_glyph(s[n], cx, y, scale, col);
+        cx += (6 * scale);
+    }
+    return n;
+}
+
+/* Cached decimal text for a HUD value; only re-formatted when it changes. */
+typedef struct { int value; int len; char text[16]; } HudNumber;
+
+typedef struct {
+    HudNumber score, level, high_score;
+    HudNumber rank[LEADERBOARD_N], row_score[LEADERBOARD_N];
+} HudCache;
+
+HudCache hud_cache;
+
+void hud_cache_init(void) {
+    HudNumber blank = { -1, 0, "" };
+    hud_cache.score = hud_cache.level = hud_cache.high_score = blank;
+    for (int i = 0; i < LEADERBOARD_N; i++) hud_cache.rank[i] = hud_cache.row_score[i] = blank;
+}
+
+/* Menu leaderboard view: TAB cycles ALL TIME, TODAY, the --player initials
+   and LEVEL 1..MAX_LEVELS; PAGE UP/DOWN pages LEADERBOARD_N rows at a time.
+   The title is re-formatted only when the view or page changes. */
+#define LB_VIEWS (3 + MAX_LEVELS)
+
+typedef struct {
+    int view, page, pages;
+    int title_view, title_page;
+    char title[32];
+} LbView;
+
+LbView lb_view = { .title_view = -1 };
+
+static void lb_view_query(int view, LbKind *kind, Uint32 *key) {
+    switch (view) {
+    case 0:  *kind = LB_ALL;    *key = 0; break;
+    case 1:  *kind = LB_DAY;    *key = today_utc(); break;
+    case 2:  *kind = LB_PLAYER; *key = initials_key(player_initials); break;
+    default: *kind = LB_LEVEL;  *key = (Uint32)(view - 2); break;
+    }
+}
+
+void lb_view_key(SDL_Keycode k) {
+    if (k == SDLK_TAB) { 
+        lb_view.view = (lb_view.view + 1) % LB_VIEWS; 
+        lb_view.page = 0; 
+    }
+    else if (k == SDLK_PAGEDOWN && lb_view.page + 1 < lb_view.pages) lb_view.page++;
+    else if (k == SDLK_PAGEUP && lb_view.page > 0) lb_view.page--;
+}
+
+static const char *lb_view_title(void) {
+    if (lb_view.title_view != lb_view.view || lb_view.title_page != lb_view.page) {
+        int v = lb_view.view, pg = lb_view.page + 1;
+        if (v == 0)      snprintf(lb_view.title, sizeof(lb_view.title), "ALL TIME  %d", pg);
+        else if (v == 1) snprintf(lb_view.title, sizeof(lb_view.title), "TODAY  %d", pg);
+        else if (v == 2) snprintf(lb_view.title, sizeof(lb_view.title), "%s  %d", player_initials, pg);
+        else             snprintf(lb_view.title, sizeof(lb_view.title), "LEVEL %d  %d", v - 2, pg);
+        lb_view.title_view = lb_view.view; 
+        lb_view.title_page = lb_view.page;
+    }
+    return lb_view.title;
+}
+
+const HudNumber *hud_number(HudNumber *h, int value) {
+    if (value < 0) value = 0;
+    if (value != h->value || h->len == 0) {
+        h->value = value;
+        h->len = snprintf(h->text, sizeof(h->text), "%d", value);
+    }
+    return h;
+}
+
+void draw_number_left(int x, int y, int scale, const HudNumber *num, SDL_Color col) {
+    for (int i = 0; i < num->len; ++i) 
+        draw_glyph(num->text[i], x + i * (6 * scale), y, scale, col);
+}
+
+void draw_number_right(int rx, int y, int scale, const HudNumber *num, SDL_Color col) {
+    int total_w = num->len * (6 * scale);
+    int start = rx - total_w + 1;
+    for (int i = 0; i < num->len; ++i) 
+        draw_glyph(num->text[i], start + i * (6 * scale), y, scale, col);
+}
+
+/* ASSET LOADER: audio decode and the score files run on a small worker
+   pool so the window and menu come up immediately. Workers only write the
+   loader's own slots; the main thread publishes them into the globals and
+   the game once every job is done (assets_poll each frame), and gameplay
+   cannot start before that (assets_wait). */
+typedef enum { ASSET_SFX_BOUNCE, ASSET_SFX_BREAK, ASSET_MUSIC, ASSET_SCORES, ASSET_COUNT } AssetJob;
+
+typedef struct {
+    SDL_Thread *workers[ASSET_COUNT];
+    int num_workers;
+    SDL_atomic_t next_job, done;
+    Mix_Chunk *bounce, *brk;
+    Mix_Music *music;
+    Game scores;                /* scratch target for load_highscore */
+    Leaderboard board;          /* built privately, moved into leaderboard on publish */
+    Uint64 started;
+} AssetLoader;
+
+AssetLoader asset_loader;
+
+static void run_asset_job(AssetLoader *al, AssetJob job) {
+    switch (job) {
+    case ASSET_SFX_BOUNCE: al->bounce = Mix_LoadWAV("bounce_real.wav"); break;
+    case ASSET_SFX_BREAK:  al->brk = Mix_LoadWAV("break_real.wav"); break;
+    case ASSET_MUSIC:      al->music = Mix_LoadMUS("bgm_arcade.wav"); break;
+    case ASSET_SCORES:     
+        load_highscore(&al->scores); 
+        load_leaderboard(&al->board); 
+        break;
+    default: break;
+    }
+}
+
+static int asset_worker(void *arg) {
+    AssetLoader *al = (AssetLoader *)arg;
+    int job;
+    while ((job = SDL_AtomicAdd(&al->next_job, 1)) < ASSET_COUNT) {
+        run_asset_job(al, (AssetJob)job);
+        SDL_AtomicAdd(&al->done, 1);
+    }
+    return 0;
+}
+
+void assets_start(void) {
+    AssetLoader *al = &asset_loader;
+    memset(al, 0, sizeof(*al));
+    al->started = SDL_GetPerformanceCounter();
+    int n = SDL_GetCPUCount();
+    if (n > ASSET_COUNT) n = ASSET_COUNT;
+    if (n < 1) n = 1;
+    for (int i = 0; i < n; i++) {
+        al->workers[al->num_workers] = SDL_CreateThread(asset_worker, "asset", al);
+        if (al->workers[al->num_workers]) al->num_workers++;
+    }
+    if (al->num_workers == 0) asset_worker(al);   /* no threads: load inline */
+}
+
+static void assets_publish(Game *g) {
+    AssetLoader *al = &asset_loader;
+    for (int i = 0; i < al->num_workers; i++) SDL_WaitThread(al->workers[i], NULL);
+    al->num_workers = 0;
+    sfx_bounce = al->bounce; 
+    sfx_break = al->brk; 
+    music_bgm = al->music;
+    g->high_score = al->scores.high_score;
+    for (int i = 0; i < leaderboard.count; i++) {
+        lb_insert(&al->board, &leaderboard.records[i]);
+        persist_record(&leaderboard.records[i]);
+        al->board.unsnapped++;
+    }
+    lb_free(&leaderboard);
+    leaderboard = al->board;
+    memset(&al->board, 0, sizeof(al->board));
+    if (leaderboard.unsnapped >= SCORES_SNAPSHOT_EVERY) leaderboard_snapshot(&leaderboard);
+    assets_ready = 1;
+}
+
+void assets_poll(Game *g) {
+    if (!assets_ready && SDL_AtomicGet(&asset_loader.done) >= ASSET_COUNT) assets_publish(g);
+}
+
+/* readiness barrier: blocks until every job has finished */
+void assets_wait(Game *g) {
+    if (!assets_ready) assets_publish(g);
+}
+/* ======================================================================== 
+   END: COMPONENT 5 - SOUND, UI & MENU SYSTEM
+   ======================================================================== */
+
+/* ========================================================================
+   START: COMPONENT 2 - GRAPHICS & RENDERING (Member 3 & 4)
+   ======================================================================== */
+
+/* The gradient is baked once and the nebula bands, which drift slowly with
+   time, are re-baked over it at BG_REFRESH_HZ into a second target.
+   Stars drift in a straight line at one speed per parallax layer, so each
+   layer is baked once into a transparent, wrap-seamless target and
+   scrolled by drift * time: a frame costs one sky copy plus four copies
+   per layer, however many stars there are. Without target support
+   everything is drawn directly, stars regenerated from STAR_SEED. */
+typedef struct { 
+    SDL_Texture *gradient, *sky; 
+    SDL_Texture *stars[STAR_LAYERS]; 
+    float baked_at; 
+    int dirty; 
+    int stars_dirty; 
+    int bands, stars_baked;     /* quality-tier counts in the baked targets */
+} BackgroundCache;
+BackgroundCache bg_cache;
+
+void draw_background_gradient(void) {
+    for (int y = 0; y < WINDOW_HEIGHT; y += 2) {
+        float ty = (float)y / (float)WINDOW_HEIGHT;
+        Uint8 cr = (Uint8)(8 + ty * 10);
+        Uint8 cg = (Uint8)(10 + ty * 20);
+        Uint8 cb = (Uint8)(28 + ty * 50);
+        batch_set_color(cr, cg, cb, 255);
+        SDL_Rect line = {0, y, WINDOW_WIDTH, 2};
+        batch_fill_rect(&line);
+    }
+}
+
+/* Lower quality tiers keep every step-th band, each step times as opaque,
+   so the nebula keeps its extent and roughly its density. */
+void draw_background_bands(float tsec) {
+    float offset = sinf(tsec * 0.12f) * 60.0f;
+    int step = BG_BANDS / quality_tier()->bands;
+    batch_set_blend(SDL_BLENDMODE_BLEND);
+    for (int i = 0; i < BG_BANDS; i += step) {
+        float py = WINDOW_HEIGHT * 0.25f + sinf(i * 0.12f + offset * 0.01f) * 16.0f + offset * 0.05f;
+        float width = WINDOW_WIDTH * (0.5f + 0.12f * sinf(i * 0.3f + offset * 0.02f));
+        Uint8 alpha = (Uint8)((20 + (i % 4) * 6) * step);
+        batch_set_color(120, 40, 200, alpha);
+        SDL_Rect band = { (int)(WINDOW_WIDTH / 2 - width / 2), (int)(py + i * 1.0f), (int)width, 6 };
+        batch_fill_rect(&band);
+    }
+}
+
+SDL_Texture *create_target_texture(void) {
+    SDL_Texture *t = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, 
+                                       WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (t) SDL_SetTextureBlendMode(t, SDL_BLENDMODE_NONE);
+    return t;
+}
+
+void background_cache_init(void) {
+    bg_cache.gradient = create_target_texture();
+    bg_cache.sky = bg_cache.gradient ? create_target_texture() : NULL;
+    if (!bg_cache.sky && bg_cache.gradient) { 
+        SDL_DestroyTexture(bg_cache.gradient); 
+        bg_cache.gradient = NULL; 
+    }
+    bg_cache.dirty = 2;
+    int layers = 0;
+    for (int l = 0; l < STAR_LAYERS && bg_cache.sky; l++) {
+        bg_cache.stars[l] = create_target_texture();
+        if (!bg_cache.stars[l]) break;
+        SDL_SetTextureBlendMode(bg_cache.stars[l], SDL_BLENDMODE_BLEND);
+        layers++;
+    }
+    if (layers < STAR_LAYERS) {
+        for (int l = 0; l < layers; l++) SDL_DestroyTexture(bg_cache.stars[l]);
+        memset(bg_cache.stars, 0, sizeof(bg_cache.stars));
+    }
+    bg_cache.stars_dirty = 1;
+}
+
+void background_cache_free(void) {
+    if (bg_cache.sky) SDL_DestroyTexture(bg_cache.sky);
+    if (bg_cache.gradient) SDL_DestroyTexture(bg_cache.gradient);
+    for (int l = 0; l < STAR_LAYERS; l++) 
+        if (bg_cache.stars[l]) SDL_DestroyTexture(bg_cache.stars[l]);
+    memset(&bg_cache, 0, sizeof(bg_cache));
+}
+
+/* target contents are lost on device/target resets */
+void background_invalidate(void) { 
+    bg_cache.dirty = 2; 
+    bg_cache.stars_dirty = 1;
+}
+
+void bake_background(float tsec) {
+    batch_flush();
+    if (bg_cache.dirty == 2) {
+        SDL_SetRenderTarget(renderer, bg_cache.gradient);
+        draw_background_gradient();
+        batch_flush();
+    }
+    SDL_SetRenderTarget(renderer, bg_cache.sky);
+    SDL_RenderCopy(renderer, bg_cache.gradient, NULL, NULL);
+    draw_background_bands(tsec);
+    batch_flush();
+    SDL_SetRenderTarget(renderer, NULL);
+    bg_cache.bands = quality_tier()->bands;
+    bg_cache.baked_at = tsec;
+    bg_cache.dirty = 0;
+}
+
+/* The stars of one layer shifted by (ox, oy) and wrapped into the window;
+   one that straddles an edge is drawn again on the far side. Layer 0 is
+   the nearest: biggest, brightest, fastest. Every quality tier draws a
+   prefix of the same sequence, so stars drop out without others moving. */
+void draw_star_layer(int layer, float ox, float oy) {
+    Uint32 rng = STAR_SEED;
+    Uint8 br = (Uint8)(180 + 40 / (layer + 1));
+    int count = quality_tier()->stars;
+    batch_set_color(br, br, br, 255);
+    for (int i = 0; i < count; i++) {
+        int l = (int)(xorshift32(&rng) % STAR_LAYERS);
+        float x = (float)(xorshift32(&rng) % WINDOW_WIDTH) + ox;
+        float y = (float)(xorshift32(&rng) % WINDOW_HEIGHT) + oy;
+        int size = 1 + (int)(xorshift32(&rng) % 2) + (STAR_LAYERS - 1 - l);
+        if (l != layer) continue;
+        x = fmodf(x, (float)WINDOW_WIDTH);
+        y = fmodf(y, (float)WINDOW_HEIGHT);
+        SDL_Rect sr = { (int)x, (int)y, size, size };
+        batch_fill_rect(&sr);
+        int wrap_x = sr.x + size > WINDOW_WIDTH, wrap_y = sr.y + size > WINDOW_HEIGHT;
+        if (wrap_x) { sr.x -= WINDOW_WIDTH; batch_fill_rect(&sr); sr.x += WINDOW_WIDTH; }
+        if (wrap_y) { sr.y -= WINDOW_HEIGHT; batch_fill_rect(&sr); }
+        if (wrap_x && wrap_y) { sr.x -= WINDOW_WIDTH; batch_fill_rect(&sr); }
+    }
+}
+
+void bake_star_layers(void) {
+    batch_flush();
+    for (int l = 0; l < STAR_LAYERS; l++) {
+        SDL_SetRenderTarget(renderer, bg_cache.stars[l]);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        draw_star_layer(l, 0.0f, 0.0f);
+        batch_flush();
+    }
+    SDL_SetRenderTarget(renderer, NULL);
+    bg_cache.stars_baked = quality_tier()->stars;
+    bg_cache.stars_dirty = 0;
+}
+
+/* Scroll offset of a layer at time tsec, in [0, window size). */
+static void star_layer_offset(int layer, float tsec, float *ox, float *oy) {
+    float v = STAR_DRIFT * (float)(STAR_LAYERS - layer);
+    *ox = fmodf(-v * tsec, (float)WINDOW_WIDTH);
+    *oy = fmodf(0.35f * v * tsec, (float)WINDOW_HEIGHT);
+    if (*ox < 0) *ox += WINDOW_WIDTH;
+    if (*oy < 0) *oy += WINDOW_HEIGHT;
+}
+
+void draw_star_field(float tsec) {
+    if (bg_cache.stars[0] && (bg_cache.stars_dirty || bg_cache.stars_baked != quality_tier()->stars)) 
+        bake_star_layers();
+    for (int l = STAR_LAYERS - 1; l >= 0; l--) {
+        float ox, oy;
+        star_layer_offset(l, tsec, &ox, &oy);
+        if (!bg_cache.stars[l]) {
+            draw_star_layer(l, ox, oy);
+            continue;
+        }
+        /* the tile's four wrapped copies cover the window */
+        int x = (int)ox, y = (int)oy;
+        SDL_Rect dst[4] = {
+            { x - WINDOW_WIDTH, y - WINDOW_HEIGHT, WINDOW_WIDTH, WINDOW_HEIGHT }, 
+            { x, y - WINDOW_HEIGHT, WINDOW_WIDTH, WINDOW_HEIGHT },
+            { x - WINDOW_WIDTH, y, WINDOW_WIDTH, WINDOW_HEIGHT }, 
+            { x, y, WINDOW_WIDTH, WINDOW_HEIGHT }
+        };
+        batch_flush();
+        for (int k = 0; k < 4; k++) SDL_RenderCopy(renderer, bg_cache.stars[l], NULL, &dst[k]);
+        frame_stats.draw_calls += 4;
+    }
+}
+
+void draw_space_background(float tsec) {
+    if (bg_cache.sky) {
+        if (bg_cache.dirty || tsec - bg_cache.baked_at >= 1.0f / BG_REFRESH_HZ || tsec < bg_cache.baked_at 
+            || bg_cache.bands != quality_tier()->bands) 
+            bake_background(tsec);
+        batch_flush();
+        SDL_RenderCopy(renderer, bg_cache.sky, NULL, NULL);
+        frame_stats.draw_calls++;
+    } else {
+        draw_background_gradient();
+        draw_background_bands(tsec);
+    }
+    draw_star_field(tsec);
+}
+
+static float lerpf(float a, float b, float t) { return a + (b - a) * t; }
+
+/* alpha: fraction of a simulation tick elapsed since the last update_engine(),
+   used to blend the ball and paddle between their previous and current tick. */
+#if ARK_PROFILE
+/* Averages over the last second of frames: one bar per phase, 20 px per ms. */
+void prof_draw_overlay(void) {
+    static ProfFrame frames[60];
+    int n = prof_snapshot(frames, 60);
+    if (!prof.show_overlay || n == 0) return;
+    double avg[PROF_COUNT] = {0}, frame_avg = 0;
+    for (int i = 0; i < n; i++) {
+        frame_avg += frames[i].frame_ns;
+        for (int p = 0; p < PROF_COUNT; p++) avg[p] += frames[i].phase_ns[p];
+    }
+    ProfFrame *last = &frames[n - 1];
+    int x = 12, y = 56, line = 14;
+    batch_set_color(0, 0, 0, 170);
+    SDL_Rect bg = { x - 6, y - 6, 330, (PROF_COUNT + 4) * line + 8 };
+    batch_fill_rect(&bg);
+
+    SDL_Color txt = { 220, 230, 255, 255 };
+    char buf[64];
+    snprintf(buf, sizeof(buf), "FRAME %d US", (int)(frame_avg / n / 1000.0));
+    draw_text_pixel(buf, x, y, 2, txt);
+    y += line;
+    for (int p = 0; p < PROF_COUNT; p++) {
+        int us = (int)(avg[p] / n / 1000.0);
+        int indent = p < PROF_FIRST_SUB ? 0 : 12;
+        SDL_Color c = p < PROF_FIRST_SUB ? txt : (SDL_Color){ 170, 180, 210, 255 };
+        draw_text_pixel(PROF_NAMES[p], x + indent, y, 1, c);
+        snprintf(buf, sizeof(buf), "%d", us);
+        draw_text_pixel(buf, x + 96, y, 1, c);
+        int w = us / 50;
+        if (w > 180) w = 180;
+        batch_set_color(p < PROF_FIRST_SUB ? 90 : 60, 200, 140, 220);
+        SDL_Rect bar = { x + 140, y, w > 0 ? w : 1, 7 };
+        batch_fill_rect(&bar);
+        y += line;
+    }
+    snprintf(buf, sizeof(buf), "DC %d Q %d", last->draw_calls, last->quads);
+    draw_text_pixel(buf, x, y, 1, txt);
+    y += line;
+    snprintf(buf, sizeof(buf), "P %d C %d T %d", last->particles, last->collectibles, last->sim_ticks);
+    draw_text_pixel(buf, x, y, 1, txt);
+    y += line;
+    snprintf(buf, sizeof(buf), "QUALITY %d OF %d%s WORK %d US", SDL_AtomicGet(&quality.tier), 
+             QUALITY_TIER_COUNT - 1, quality.pinned ? " PIN" : "", (int)(quality.work_ms * 1000.0));
+    draw_text_pixel(buf, x, y, 1, txt);
+}
+#endif
+
+void render_scene(Game *g, float alpha) {
+    float tsec = (float)(SDL_GetTicks() / 1000.0f);
+    batch_begin_frame();
+    PROF_BEGIN(PROF_BACKGROUND);
+    draw_space_background(tsec);
+    PROF_END(PROF_BACKGROUND);
+
+    PROF_BEGIN(PROF_BRICKS);
+    if (brick_layer.tex) {
+        update_brick_layer(g);
+        batch_flush();
+        SDL_RenderCopy(renderer, brick_layer.tex, NULL, NULL);
+        frame_stats.draw_calls++;
+    } else {
+        draw_board(&g->board);
+    }
+
+    PROF_END(PROF_BRICKS);
+
+    PROF_BEGIN(PROF_PARTICLES_DRAW);
+    ParticleSystem *ps = &g->particles;
+    for (int i = 0; i < ps->count; i++) { 
+        float life_t = ps->life[i] / ps->max_life[i]; 
+        Uint8 a = (Uint8)(255 * (1.0f - life_t)); 
+        SDL_Color pc = color_palette[ps->color[i] % 10]; 
+        batch_set_color(pc.r, pc.g, pc.b, a); 
+        SDL_Rect pr = { (int)ps->x[i], (int)ps->y[i], 3, 3 }; 
+        batch_fill_rect(&pr); 
+    }
+
+    for (int ci = 0; ci < MAX_COLLECTIBLES; ci++) { 
+        if (!g->collectibles[ci].alive) continue; 
+        const RectF *cf = &g->collectibles[ci].rect;
+        if (sprite_atlas.tex && cf->w == COLLECTIBLE_SIZE && cf->h == COLLECTIBLE_SIZE) {
+            draw_sprite(ATLAS_COLLECT + g->collectibles[ci].type, (int)cf->x, (int)cf->y);
+            continue;
+        }
+        if (g->collectibles[ci].type == COLLECT_MULTIBALL) batch_set_color(90, 220, 255, 255);
+        else batch_set_color(255, 200, 80, 255); 
+        SDL_Rect cr = { (int)g->collectibles[ci].rect.x, (int)g->collectibles[ci].rect.y, 
+                        (int)g->collectibles[ci].rect.w, (int)g->collectibles[ci].rect.h }; 
+        batch_fill_rect(&cr); 
+        batch_set_color(255, 255, 255, 100); 
+        batch_outline_rect(&cr); 
+    }
+    PROF_END(PROF_PARTICLES_DRAW);
+
+    Paddle draw_p = g->paddle;
+    draw_p.rect.x = lerpf(g->paddle_prev_rect.x, g->paddle.rect.x, alpha);
+    draw_paddle(&draw_p);
+    for (int i = 0; i < g->ball_count; i++) {
+        Ball draw_b = g->balls[i];
+        draw_b.rect.x = lerpf(g->ball_prev_rect[i].x, g->balls[i].rect.x, alpha);
+        draw_b.rect.y = lerpf(g->ball_prev_rect[i].y, g->balls[i].rect.y, alpha);
+        draw_ball_with_glow(&draw_b);
+    }
+
+    PROF_BEGIN(PROF_HUD);
+    SDL_Rect hudStrip = { 0, 0, WINDOW_WIDTH, 44 };
+    batch_set_color(6, 8, 20, 220);
+    batch_fill_rect(&hudStrip);
+
+    SDL_Color fg = { 235, 235, 255, 255 };
+    int labelScale = 2;
+    int digitScale = 4;
 
     int sx = 18;
     int sy = 8;
-    SDL_SetRenderDrawColor(renderer, 40, 48, 80, 220);
+    batch_set_color(40, 48, 80, 220);
     SDL_Rect labScoreBox = { sx - 6, sy - 4, 160, 32 };
-    SDL_RenderFillRect(renderer, &labScoreBox);
+    batch_fill_rect(&labScoreBox);
     draw_text_pixel("SCORE", sx, sy + 2, labelScale, fg);
     int score_x_right = sx + 150;
-    draw_number_right(score_x_right, sy + 4, digitScale, game_state.score, fg);
+    draw_number_right(score_x_right, sy + 4, digitScale, hud_number(&hud_cache.score, g->game_state.score), fg);
+
+    int mx = WINDOW_WIDTH/2 - 80;
+    batch_set_color(40, 48, 80, 220);
+    SDL_Rect labLevelBox = { mx - 6, sy - 4, 160, 32 };
+    batch_fill_rect(&labLevelBox);
+    draw_text_pixel("LEVEL", mx, sy + 2, labelScale, fg);
+    draw_number_right(mx + 130, sy + 4, digitScale, hud_number(&hud_cache.level, g->game_state.level), fg);
+
+    int rx = WINDOW_WIDTH - 20;
+    int heart_w = HEART_W, heart_h = HEART_H, gap = 10;
+    for (int i = 0; i < g->game_state.lives; i++) {
+        int hx = rx - heart_w;
+        int hy = sy + 6;
+        rx -= (heart_w + gap);
+        if (sprite_atlas.tex) {
+            draw_sprite(ATLAS_HEART, hx, hy);
+            continue;
+        }
+        batch_set_color(255, 80, 120, 255);
+        SDL_Rect left = { hx, hy, heart_w/2, heart_h/2 };
+        SDL_Rect right = { hx + heart_w/2, hy, heart_w/2, heart_h/2 };
+        SDL_Rect bottom = { hx + heart_w/4, hy + heart_h/4, heart_w/2, heart_h*3/4 };
+        batch_fill_rect(&left);
+        batch_fill_rect(&right);
+        batch_fill_rect(&bottom);
+    }
+
+    if (g->game_state.show_menu) {
+        batch_set_blend(SDL_BLENDMODE_BLEND);
+        batch_set_color(0, 0, 0, 200);
+        SDL_Rect full = {0,0,WINDOW_WIDTH,WINDOW_HEIGHT};
+        batch_fill_rect(&full);
+
+        SDL_Color titleCol = {255,140,70,255};
+        int titleScale = 10;
+        static const char title[] = "ARKANOID";
+        int tw = (int)(sizeof(title) - 1) * ((5 * titleScale) + titleScale);
+        int tx = (WINDOW_WIDTH - tw) / 2;
+        int ty = 80;
+        draw_text_pixel(title, tx, ty, titleScale, titleCol);
+
+        SDL_Color scoreCol = {255,80,80,255};
+        int hs_x = WINDOW_WIDTH/2 - 60;
+        int label_w = draw_text_pixel("HIGH SCORE", hs_x, 18, 2, scoreCol) * (6 * 2);
+        int num_x = hs_x + label_w + 8;
+        draw_number_left(num_x, 18 + 6, 3, hud_number(&hud_cache.high_score, g->high_score), (SDL_Color){255,255,255,255});
+
+        int pw = 220, ph = 72;
+        menu_play_rect.x = (WINDOW_WIDTH - pw)/2; 
+        menu_play_rect.y = ty + 180; 
+        menu_play_rect.w = pw; 
+        menu_play_rect.h = ph;
+        SDL_Rect pr = {(int)menu_play_rect.x, (int)menu_play_rect.y, 
+                       (int)menu_play_rect.w, (int)menu_play_rect.h};
+        batch_set_color(40,20,90,220);
+        batch_fill_rect(&pr);
+        draw_text_pixel("PLAY", (int)menu_play_rect.x + 56, (int)menu_play_rect.y + 12, 6, 
+                       (SDL_Color){255,180,200,255});
+        draw_text_pixel(assets_ready ? "TAP TO START" : "LOADING", WINDOW_WIDTH/2 - 70, 
+                       (int)menu_play_rect.y + ph + 18, 2, (SDL_Color){200,200,220,200});
+
+        int lb_x = WINDOW_WIDTH/2 - 140;
+        int lb_y = (int)menu_play_rect.y + ph + 60;
+        draw_text_pixel(lb_view_title(), lb_x, lb_y, 2, (SDL_Color){200,180,240,255});
+        LbKind kind; 
+        Uint32 key;
+        lb_view_query(lb_view.view, &kind, &key);
+        const ScoreRecord *rows[LEADERBOARD_N];
+        int total = 0;
+        int n = assets_ready ? lb_page(&leaderboard, kind, key, lb_view.page, LEADERBOARD_N, rows, &total) : 0;
+        lb_view.pages = total > 0 ? (total + LEADERBOARD_N - 1) / LEADERBOARD_N : 1;
+        for (int i = 0; i < n; i++) {
+            int ry = lb_y + 26 + i*22;
+            draw_number_right(lb_x + 48, ry, 2, 
+                              hud_number(&hud_cache.rank[i], lb_view.page * LEADERBOARD_N + i + 1), 
+                              (SDL_Color){220,220,220,230});
+            draw_text_pixel(rows[i]->initials, lb_x + 72, ry, 2, (SDL_Color){200,220,255,230});
+            draw_number_left(lb_x + 132, ry, 2, hud_number(&hud_cache.row_score[i], rows[i]->score), 
+                             (SDL_Color){255,255,255,255});
+        }
+    }
+#if ARK_PROFILE
+    prof_draw_overlay();
+#endif
+    PROF_END(PROF_HUD);
+    PROF_BEGIN(PROF_SUBMIT);
+    batch_end_frame();
+    PROF_END(PROF_SUBMIT);
+}
+/* ======================================================================== 
+   END: COMPONENT 2 - GRAPHICS & RENDERING
+   ======================================================================== */
+
+/* ========================================================================
+   START: COMPONENT 3 - INPUT HANDLING (Member 5 & 6)
+   ======================================================================== */
+/* Mouse motion is coalesced: events only record the newest position, which
+   is applied once per frame after the queue is drained. With late latching
+   the mouse is sampled again right before render_scene, so the paddle is
+   drawn where the cursor is at draw time. Latency is measured from the
+   newest applied sample to the return of SDL_RenderPresent. */
+typedef struct {
+    int late_latch;
+    int mouse_active;           /* last paddle input came from the mouse */
+    int have_sample, mouse_x;
+    Uint32 sample_ms;           /* SDL event timestamp */
+    Uint64 sample_pc;           /* perf counter, for late-latched samples */
+    int measure;
+    Uint64 samples;
+    double sum_ms, max_ms;
+} InputLatch;
+
+InputLatch input_latch = { .late_latch = 1 };
+
+static void set_paddle_from_mouse(Game *g, int mx) {
+    g->paddle.rect.x = mx - g->paddle.rect.w/2; 
+    clamp_paddle_position(g); 
+    g->paddle_prev_rect.x = g->paddle.rect.x;   /* position is absolute: no lerp */
+}
+
+void apply_mouse_sample(Game *g) {
+    InputLatch *in = &input_latch;
+    if (!in->have_sample) return;
+    set_paddle_from_mouse(g, in->mouse_x);
+    in->have_sample = 0;
+    in->sample_pc = 0;
+    in->measure = 1;
+}
+
+void late_latch_paddle(Game *g) {
+    InputLatch *in = &input_latch;
+    if (!in->late_latch || !in->mouse_active) return;
+    int mx, my;
+    SDL_PumpEvents();
+    SDL_GetMouseState(&mx, &my);
+    if (mx == in->mouse_x) return;
+    in->mouse_x = mx;
+    set_paddle_from_mouse(g, mx);
+    in->sample_pc = SDL_GetPerformanceCounter();
+    in->measure = 1;
+}
+
+void input_note_present(void) {
+    InputLatch *in = &input_latch;
+    if (!in->measure) return;
+    double ms = in->sample_pc 
+        ? (double)(SDL_GetPerformanceCounter() - in->sample_pc) * 1000.0 / (double)SDL_GetPerformanceFrequency() 
+        : (double)(SDL_GetTicks() - in->sample_ms);
+    in->samples++;
+    in->sum_ms += ms;
+    if (ms > in->max_ms) in->max_ms = ms;
+    in->measure = 0;
+}
+
+void input_report(void) {
+    const InputLatch *in = &input_latch;
+    if (!in->samples) return;
+    fprintf(stderr, "input: late latch %s, %llu mouse samples, input-to-present avg %.2f ms, max %.2f ms\n", 
+            in->late_latch ? "on" : "off", (unsigned long long)in->samples, 
+            in->sum_ms / (double)in->samples, in->max_ms);
+}
+
+/* Commands are applied at once by the core and logged for replay, which
+   feeds the same commands back in. In threaded mode they are queued for
+   the sim thread, which does the same between two ticks. */
+void game_command(Game *g, GameCommand cmd) {
+    if (sim_link.active) sim_post_command(&sim_link, cmd);
+    else if (ark_command(g, cmd)) replay_note_command(&replay, cmd);
+}
+
+void handle_input(Game *g, SDL_Event *ev) {
+    if (ev->type == SDL_QUIT) { 
+        g->game_state.is_running = 0; 
+    }
+    else if (ev->type == SDL_RENDER_TARGETS_RESET || ev->type == SDL_RENDER_DEVICE_RESET) {
+        background_invalidate();
+        brick_layer_invalidate();
+    }
+    else if (ev->type == SDL_KEYDOWN) {
+        SDL_Keycode k = ev->key.keysym.sym;
+        if (k == SDLK_ESCAPE) { 
+            if (g->game_state.show_menu) 
+                g->game_state.is_running = 0; 
+            else 
+                game_command(g, CMD_MENU); 
+        }
+        else if (k == SDLK_SPACE) {
+            if (g->game_state.show_menu) { 
+                assets_wait(g);
+                game_command(g, CMD_START);
+                if (music_bgm) Mix_PlayMusic(music_bgm, -1); 
+            }
+            else 
+                game_command(g, CMD_SPACE);
+        }
+#if ARK_PROFILE
+        else if (k == SDLK_F3) 
+            prof.show_overlay = !prof.show_overlay;
+        else if (k == SDLK_F4) {
+            int n = prof_export("arkanoid_trace.json", "arkanoid_frames.csv");
+            fprintf(stderr, "profiler: exported %d frames\n", n);
+        }
+#endif
+        else if (g->game_state.show_menu && (k == SDLK_TAB || k == SDLK_PAGEUP || k == SDLK_PAGEDOWN)) 
+            lb_view_key(k);
+        else if (k == SDLK_r) 
+            game_command(g, CMD_RESET);
+        else if (k == SDLK_m) { 
+            if (Mix_PlayingMusic()) 
+                Mix_PausedMusic() ? Mix_ResumeMusic() : Mix_PauseMusic(); 
+            else if (music_bgm) 
+                Mix_PlayMusic(music_bgm, -1); 
+        }
+    }
+    else if (ev->type == SDL_MOUSEMOTION) { 
+        input_latch.mouse_x = ev->motion.x; 
+        input_latch.sample_ms = ev->motion.timestamp;
+        input_latch.have_sample = 1; 
+        input_latch.mouse_active = 1;
+    }
+    else if (ev->type == SDL_MOUSEBUTTONDOWN) {
+        int mx = ev->button.x, my = ev->button.y;
+        if (g->game_state.show_menu) {
+            if (mx >= (int)menu_play_rect.x && mx <= (int)(menu_play_rect.x + menu_play_rect.w) && 
+                my >= (int)menu_play_rect.y && my <= (int)(menu_play_rect.y + menu_play_rect.h)) {
+                assets_wait(g);
+                game_command(g, CMD_START);
+                if (music_bgm) Mix_PlayMusic(music_bgm, -1);
+            }
+        }
+    }
+}
+/* ======================================================================== 
+   END: COMPONENT 3 - INPUT HANDLING
+   ======================================================================== */
+
+/* ========================================================================
+   START: COMPONENT 2 - GRAPHICS & RENDERING (Member 3 & 4)
+   ======================================================================== */
+int init_color_palette() { 
+    color_palette[0]=(SDL_Color){255,120,120,255}; 
+    color_palette[1]=(SDL_Color){255,200,80,255}; 
+    color_palette[2]=(SDL_Color){110,255,170,255}; 
+    color_palette[3]=(SDL_Color){90,160,255,255}; 
+    color_palette[4]=(SDL_Color){210,90,200,255}; 
+    color_palette[5]=(SDL_Color){120,200,255,255}; 
+    color_palette[6]=(SDL_Color){255,150,60,255}; 
+    color_palette[7]=(SDL_Color){170,120,255,255}; 
+    color_palette[8]=(SDL_Color){160,255,200,255}; 
+    color_palette[9]=(SDL_Color){255,100,180,255}; 
+    return 1; 
+}
+/* ======================================================================== 
+   END: COMPONENT 2 - GRAPHICS & RENDERING
+   ======================================================================== */
+
+/* ========================================================================
+   START: COMPONENT 5 - SOUND, UI & MENU SYSTEM (Member 9 & 10)
+   ======================================================================== */
+/* Sound effects are played from a dedicated thread. Once per frame the main
+   thread drains the game's pending bits, drops any type that played less
+   than SFX_MIN_GAP_MS ago and pushes the rest into a single-producer /
+   single-consumer ring; the audio thread sleeps on a semaphore and turns
+   each event into Mix_PlayChannel. */
+typedef struct {
+    Uint8 ring[SFX_QUEUE_SIZE];
+    SDL_atomic_t head, tail;    /* head: next write (main), tail: next read (audio) */
+    SDL_sem *wake;
+    SDL_Thread *thread;
+    SDL_atomic_t quit;
+    Uint32 last_ms[SFX_COUNT];
+} AudioQueue;
+
+AudioQueue audio_q;
+
+static Mix_Chunk *sfx_chunk(SfxType type) {
+    return type == SFX_BRICK ? sfx_break : sfx_bounce;
+}
+
+static int audio_thread_main(void *arg) {
+    AudioQueue *q = (AudioQueue *)arg;
+    for (;;) {
+        SDL_SemWait(q->wake);
+        int tail = SDL_AtomicGet(&q->tail);
+        while (tail != SDL_AtomicGet(&q->head)) {
+            Mix_Chunk *chunk = sfx_chunk((SfxType)q->ring[tail % SFX_QUEUE_SIZE]);
+            if (chunk) Mix_PlayChannel(-1, chunk, 0);
+            SDL_AtomicSet(&q->tail, ++tail);
+        }
+        if (SDL_AtomicGet(&q->quit)) break;
+    }
+    return 0;
+}
+
+void audio_start(void) {
+    memset(&audio_q, 0, sizeof(audio_q));
+    audio_q.wake = SDL_CreateSemaphore(0);
+    if (audio_q.wake) audio_q.thread = SDL_CreateThread(audio_thread_main, "audio", &audio_q);
+    if (!audio_q.thread) fprintf(stderr, "Audio thread fail, playing inline: %s\n", SDL_GetError());
+}
+
+void audio_stop(void) {
+    if (audio_q.thread) {
+        SDL_AtomicSet(&audio_q.quit, 1);
+        SDL_SemPost(audio_q.wake);
+        SDL_WaitThread(audio_q.thread, NULL);
+    }
+    if (audio_q.wake) SDL_DestroySemaphore(audio_q.wake);
+    memset(&audio_q, 0, sizeof(audio_q));
+}
+
+/* Core play_sfx hook, called once per pending event by ark_drain_sfx. */
+static void sdl_play_sfx(void *user, SfxType t) {
+    (void)user;
+    Uint32 now = SDL_GetTicks();
+    if (now - audio_q.last_ms[t] < SFX_MIN_GAP_MS) return;
+    audio_q.last_ms[t] = now;
+    if (!audio_q.thread) {
+        if (sfx_chunk(t)) Mix_PlayChannel(-1, sfx_chunk(t), 0);
+        return;
+    }
+    int head = SDL_AtomicGet(&audio_q.head);
+    if (head - SDL_AtomicGet(&audio_q.tail) >= SFX_QUEUE_SIZE) return;   /* full: drop */
+    audio_q.ring[head % SFX_QUEUE_SIZE] = (Uint8)t;
+    SDL_AtomicSet(&audio_q.head, head + 1);
+    SDL_SemPost(audio_q.wake);
+}
+
+void audio_submit(Game *g) {
+    ark_drain_sfx(g);
+}
+
+/* Hooks the core calls back into. Rendering and input stay in this file's
+   own loop (late latching, replay), so those two are not used here. */
+const ArkBackend sdl_backend = {
+    NULL, sdl_level_cells, sdl_game_over, sdl_play_sfx, NULL, NULL
+};
+
+int initialize_all(Game *g, Uint32 seed) {
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER) != 0) { 
+        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError()); 
+        return 0; 
+    }
+    window = SDL_CreateWindow("Arkanoid - Final", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 
+                              WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
+    if (!window) { 
+        fprintf(stderr, "Window create fail: %s\n", SDL_GetError()); 
+        return 0; 
+    }
+    Uint32 rflags = SDL_RENDERER_ACCELERATED | (pacer_wants_vsync(&pacer) ? SDL_RENDERER_PRESENTVSYNC : 0);
+    renderer = SDL_CreateRenderer(window, -1, rflags);
+    if (!renderer) { 
+        fprintf(stderr, "Renderer fail: %s\n", SDL_GetError()); 
+        return 0; 
+    }
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) < 0) { 
+        fprintf(stderr, "Mix_OpenAudio fail: %s\n", Mix_GetError()); 
+    }
+    init_color_palette();
+    if (!sprite_atlas_init()) 
+        fprintf(stderr, "Sprite atlas fail, drawing text and sprites as fills: %s\n", SDL_GetError());
+    hud_cache_init();
+    background_cache_init();
+    brick_layer_init();
+    init_game(g, &sdl_backend, seed, 0);
+    g->ball_collisions = ball_collisions;
+    if (!particles_init(&g->particles, MAX_PARTICLES)) { 
+        fprintf(stderr, "Particle pool alloc fail\n"); 
+        return 0; 
+    }
+    assets_start();
+    audio_start();
+    persist_start();
+    return 1;
+}
+
+void cleanup_all(Game *g) {
+    assets_wait(g);
+    if (g->game_state.score > g->high_score) { 
+        g->high_score = g->game_state.score; 
+        save_highscore(g); 
+    }
+    persist_stop();
+    lb_free(&leaderboard);
+    particles_free(&g->particles);
+    batch_free();
+    sprite_atlas_free();
+    background_cache_free();
+    brick_layer_free();
+    audio_stop();
+    if (sfx_bounce) Mix_FreeChunk(sfx_bounce); 
+    if (sfx_break) Mix_FreeChunk(sfx_break); 
+    if (music_bgm) Mix_FreeMusic(music_bgm);
+    Mix_CloseAudio();
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (window) SDL_DestroyWindow(window);
+    SDL_Quit();
+}
+/* ======================================================================== 
+   END: COMPONENT 5 - SOUND, UI & MENU SYSTEM
+   ======================================================================== */
+
+/* ========================================================================
+   THREADED MODE
+   - --threaded: the sim thread owns the Game and ticks it at sim_tick_hz
+     on its own clock (SDL_Delay, then spin, like the cap pacer), so a slow
+     present or a GPU stall no longer holds back physics; e.g.
+     --threaded --tick-rate 240 on a 60 Hz display
+   - After every tick it publishes an immutable SimSnapshot through a
+     lock-free triple buffer: one slot being written, one ready, one being
+     drawn. Publishing and taking the newest slot are a single atomic swap
+     each; the renderer always gets the latest tick and skips the rest
+   - A snapshot carries what render_scene reads: balls, paddle, pickups,
+     HUD values, the alive mask (the main thread diffs it into its
+     brick-layer dirty queue) and the live particle range. Level cells are
+     only copied into a slot when the level changed since it was last used
+   - The end of a run is handled on the main thread, which owns the score
+     files and leaderboard; the sim thread only counts it
+   - Replay recording and sound submission stay on the sim thread; the
+     profiler's collision scope is timed there too and lands in whichever
+     frame the main thread has open
+   ======================================================================== */
+#define SNAP_FRESH 4            /* SnapshotBuffer.latest: published, not yet taken */
+
+typedef struct {
+    Paddle paddle;
+    RectF paddle_prev_rect;
+    Ball balls[MAX_BALLS];
+    RectF ball_prev_rect[MAX_BALLS];
+    int ball_count;
+    Collectible collectibles[MAX_COLLECTIBLES];
+    GameState game_state;
+    int game_overs;             /* runs ended so far */
+    Uint64 tick_pc;             /* when this tick's state became current */
+    uint32_t board_serial;
+    int rows, cols;
+    uint64_t alive[BOARD_WORDS];
+    uint32_t cells_serial;      /* board the cells below belong to */
+    uint8_t cells[BOARD_MAX_CELLS];
+    ParticleSystem particles;   /* live range only; vx/vy are not copied */
+} SimSnapshot;
+
+typedef struct {
+    SimSnapshot *slot[3];
+    SDL_atomic_t latest;        /* ready slot index, | SNAP_FRESH */
+    int back;                   /* sim thread's slot */
+    int front;                  /* main thread's slot */
+} SnapshotBuffer;
+
+typedef struct {
+    Game *game;
+    SDL_Thread *thread;
+    SnapshotBuffer snaps;
+    FramePacer clock;           /* only its sleep helper and freq are used */
+    int game_overs;
+    SDL_atomic_t ticks, drops;
+} ThreadedSim;
+
+ThreadedSim threaded_sim;
+
+/* Sim thread: hand the finished back slot over and take the old ready one. */
+static void snapshot_publish(SnapshotBuffer *sb) {
+    int prev = SDL_AtomicSet(&sb->latest, sb->back | SNAP_FRESH);
+    sb->back = prev & 3;
+}
+
+/* Main thread: the newest published snapshot, or the one it already holds. */
+static const SimSnapshot *snapshot_acquire(SnapshotBuffer *sb) {
+    if (SDL_AtomicGet(&sb->latest) & SNAP_FRESH) {
+        int prev = SDL_AtomicSet(&sb->latest, sb->front);
+        sb->front = prev & 3;
+    }
+    return sb->slot[sb->front];
+}
+
+static void snapshot_capture(SimSnapshot *s, const Game *g, int game_overs) {
+    s->paddle = g->paddle;
+    s->paddle_prev_rect = g->paddle_prev_rect;
+    s->ball_count = g->ball_count;
+    memcpy(s->balls, g->balls, (size_t)g->ball_count * sizeof(Ball));
+    memcpy(s->ball_prev_rect, g->ball_prev_rect, (size_t)g->ball_count * sizeof(RectF));
+    memcpy(s->collectibles, g->collectibles, sizeof(s->collectibles));
+    s->game_state = g->game_state;
+    s->game_overs = game_overs;
+    s->tick_pc = SDL_GetPerformanceCounter();
+
+    const Board *b = &g->board;
+    int n = b->rows * b->cols;
+    s->board_serial = b->serial;
+    s->rows = b->rows;
+    s->cols = b->cols;
+    memcpy(s->alive, b->alive, (size_t)(n + 63) / 64 * sizeof(uint64_t));
+    if (s->cells_serial != b->serial) {
+        memcpy(s->cells, b->cells, (size_t)n);
+        s->cells_serial = b->serial;
+    }
+
+    const ParticleSystem *src = &g->particles;
+    ParticleSystem *dst = &s->particles;
+    int count = src->count < dst->capacity ? src->count : dst->capacity;
+    size_t fb = (size_t)count * sizeof(float);
+    memcpy(dst->x, src->x, fb);
+    memcpy(dst->y, src->y, fb);
+    memcpy(dst->life, src->life, fb);
+    memcpy(dst->max_life, src->max_life, fb);
+    memcpy(dst->color, src->color, (size_t)count);
+    dst->count = count;
+}
+
+/* Main thread: brings its render-only Game up to the snapshot. Bricks that
+   died since the last one go on the brick layer's dirty queue; a new
+   level rebuilds the board. Returns 1 if a run ended meanwhile. */
+static int view_apply(Game *v, const SimSnapshot *s, int *game_overs) {
+    v->paddle = s->paddle;
+    v->paddle_prev_rect = s->paddle_prev_rect;
+    v->ball_count = s->ball_count;
+    memcpy(v->balls, s->balls, (size_t)s->ball_count * sizeof(Ball));
+    memcpy(v->ball_prev_rect, s->ball_prev_rect, (size_t)s->ball_count * sizeof(RectF));
+    memcpy(v->collectibles, s->collectibles, sizeof(v->collectibles));
+    v->game_state = s->game_state;
+    v->particles = s->particles;    /* borrowed until the next acquire */
+
+    Board *b = &v->board;
+    int words = (s->rows * s->cols + 63) / 64;
+    if (b->serial != s->board_serial) {
+        board_layout(b, s->rows, s->cols);
+        memcpy(b->cells, s->cells, (size_t)s->rows * s->cols);
+        memcpy(b->alive, s->alive, (size_t)words * sizeof(uint64_t));
+        b->serial = s->board_serial;
+    } else {
+        /* bricks never come back within a level: only deaths to patch */
+        for (int w = 0; w < words; w++) {
+            uint64_t gone = b->alive[w] & ~s->alive[w];
+            for (; gone; gone &= gone - 1) {
+                if (b->dirty_count < BOARD_DIRTY_MAX) b->dirty[b->dirty_count++] = (uint32_t)(w * 64 + ctz64(gone));
+                else b->dirty_all = 1;
+            }
+            b->alive[w] = s->alive[w];
+        }
+    }
+    if (s->game_overs == *game_overs) return 0;
+    *game_overs = s->game_overs;
+    return 1;
+}
+
+static void threaded_game_over(void *user, Game *g) {
+    (void)g;
+    ((ThreadedSim *)user)->game_overs++;
+}
+
+const ArkBackend threaded_backend = {
+    &threaded_sim, sdl_level_cells, threaded_game_over, sdl_play_sfx, NULL, NULL
+};
+
+static int sim_thread_main(void *arg) {
+    ThreadedSim *ts = (ThreadedSim *)arg;
+    SimLink *l = &sim_link;
+    Game *g = ts->game;
+    const float dt = 1.0f / (float)sim_tick_hz;
+    const Uint64 period = (Uint64)(ts->clock.freq / sim_tick_hz);
+    Uint64 next = SDL_GetPerformanceCounter();
+    while (!SDL_AtomicGet(&l->quit)) {
+        GameCommand cmd;
+        while (sim_next_command(l, &cmd)) 
+            if (ark_command(g, cmd)) replay_note_command(&replay, cmd);
+        int mx = SDL_AtomicSet(&l->mouse_x, 0);
+        if (mx) set_paddle_from_mouse(g, mx - 1);
+        g->paddle.velocity_x = (float)SDL_AtomicGet(&l->paddle_dir) * PADDLE_SPEED;
+        g->fx_density = quality_tier()->particle_pct;
+
+        snap_interpolation_state(g);
+        g->paddle.rect.x += g->paddle.velocity_x * dt; 
+        clamp_paddle_position(g); 
+        replay_record_tick(&replay, g);
+        update_engine(g, dt); 
+        replay_record_result(&replay, g);
+        spectate_tick(&spec_out, g);
+        audio_submit(g);
+
+        snapshot_capture(ts->snaps.slot[ts->snaps.back], g, ts->game_overs);
+        snapshot_publish(&ts->snaps);
+        SDL_AtomicAdd(&ts->ticks, 1);
+
+        next += period;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now > next + period * SIM_MAX_TICKS_PER_FRAME) {
+            next = now;     /* fell too far behind: drop the backlog */
+            SDL_AtomicAdd(&ts->drops, 1);
+        } else {
+            pacer_sleep_until(&ts->clock, next);
+        }
+    }
+    return 0;
+}
+
+static void threaded_free(ThreadedSim *ts) {
+    for (int i = 0; i < 3; i++) {
+        if (!ts->snaps.slot[i]) continue;
+        particles_free(&ts->snaps.slot[i]->particles);
+        free(ts->snaps.slot[i]);
+        ts->snaps.slot[i] = NULL;
+    }
+}
 
-    int mx = WINDOW_WIDTH/2 - 80;
-    SDL_SetRenderDrawColor(renderer, 40, 48, 80, 220);
-    SDL_Rect labLevelBox = { mx - 6, sy - 4, 160, 32 };
-    SDL_RenderFillRect(renderer, &labLevelBox);
-    draw_text_pixel("LEVEL", mx, sy + 2, labelScale, fg);
-    draw_number_right(mx + 130, sy + 4, digitScale, game_state.level, fg);
+/* The --threaded main loop. Returns 0 without running if the snapshots or
+   the thread can't be set up, and the caller falls back to its own loop. */
+int run_threaded(Game *g) {
+    ThreadedSim *ts = &threaded_sim;
+    memset(ts, 0, sizeof(*ts));
+    ts->game = g;
+    ts->clock.freq = (double)SDL_GetPerformanceFrequency();
+    Game *view = (Game *)malloc(sizeof(Game));
+    int ok = view != NULL;
+    for (int i = 0; i < 3 && ok; i++) {
+        ts->snaps.slot[i] = (SimSnapshot *)calloc(1, sizeof(SimSnapshot));
+        ok = ts->snaps.slot[i] && particles_init(&ts->snaps.slot[i]->particles, g->particles.capacity);
+    }
+    if (ok) {
+        /* slot 0 starts out drawn, 1 ready, 2 written */
+        init_game(view, NULL, 0, 0);
+        view->high_score = g->high_score;
+        snapshot_capture(ts->snaps.slot[0], g, 0);
+        ts->snaps.front = 0;
+        SDL_AtomicSet(&ts->snaps.latest, 1);
+        ts->snaps.back = 2;
+        memset(&sim_link, 0, sizeof(sim_link));
+        g->backend = &threaded_backend;
+        sim_link.active = 1;
+        ts->thread = SDL_CreateThread(sim_thread_main, "sim", ts);
+        ok = ts->thread != NULL;
+    }
+    if (!ok) {
+        fprintf(stderr, "threaded: setup failed, running single-threaded\n");
+        sim_link.active = 0;
+        g->backend = &sdl_backend;
+        threaded_free(ts);
+        free(view);
+        return 0;
+    }
 
-    int rx = WINDOW_WIDTH - 20;
-    int heart_w = 20, heart_h = 18, gap = 10;
-    for (int i = 0; i < game_state.lives; i++) {
-        int hx = rx - heart_w;
-        int hy = sy + 6;
-        SDL_SetRenderDrawColor(renderer, 255, 80, 120, 255);
-        SDL_Rect left = { hx, hy, heart_w/2, heart_h/2 };
-        SDL_Rect right = { hx + heart_w/2, hy, heart_w/2, heart_h/2 };
-        SDL_Rect bottom = { hx + heart_w/4, hy + heart_h/4, heart_w/2, heart_h*3/4 };
-        SDL_RenderFillRect(renderer, &left);
-        SDL_RenderFillRect(renderer, &right);
-        SDL_RenderFillRect(renderer, &bottom);
-        rx -= (heart_w + gap);
+    int game_overs = 0, posted_x = -1;
+#if ARK_PROFILE
+    int ticks_seen = 0;
+#endif
+    const double tick_period = ts->clock.freq / sim_tick_hz;
+    Uint64 frame_start = SDL_GetPerformanceCounter();
+    SDL_Event ev;
+    for (;;) {
+#if ARK_PROFILE
+        prof_frame_begin();
+#endif
+        Uint64 prev_start = frame_start;
+        frame_start = SDL_GetPerformanceCounter();
+        const SimSnapshot *snap = snapshot_acquire(&ts->snaps);
+        if (view_apply(view, snap, &game_overs)) sdl_game_over(NULL, view);
+        if (!view->game_state.is_running) break;
+        
+        PROF_BEGIN(PROF_INPUT);
+        while (SDL_PollEvent(&ev)) handle_input(view, &ev);
+        assets_poll(view);
+        apply_mouse_sample(view);
+        const Uint8 *ks = SDL_GetKeyboardState(NULL); 
+        int dir = 0;
+        if (ks[SDL_SCANCODE_LEFT] || ks[SDL_SCANCODE_A]) dir = -1; 
+        if (ks[SDL_SCANCODE_RIGHT] || ks[SDL_SCANCODE_D]) dir = 1; 
+        if (dir != 0) input_latch.mouse_active = 0;
+        SDL_AtomicSet(&sim_link.paddle_dir, dir);
+        PROF_END(PROF_INPUT);
+        if (!view->game_state.is_running) break;
+        
+        PROF_BEGIN(PROF_RENDER);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND); 
+        late_latch_paddle(view);
+        if (input_latch.mouse_active && input_latch.mouse_x != posted_x) {
+            posted_x = input_latch.mouse_x;
+            SDL_AtomicSet(&sim_link.mouse_x, posted_x + 1);
+        }
+        double alpha = (double)(SDL_GetPerformanceCounter() - snap->tick_pc) / tick_period;
+        render_scene(view, (float)(alpha < 1.0 ? alpha : 1.0)); 
+        PROF_END(PROF_RENDER);
+        double work = (double)(SDL_GetPerformanceCounter() - frame_start) / ts->clock.freq;
+        PROF_BEGIN(PROF_PRESENT);
+        SDL_RenderPresent(renderer); 
+        input_note_present();
+        PROF_END(PROF_PRESENT);
+        PROF_BEGIN(PROF_SLEEP);
+        int idle = view->game_state.show_menu || view->game_state.is_paused;
+        pacer_wait(&pacer, idle);
+        PROF_END(PROF_SLEEP);
+        quality_note_frame((double)(frame_start - prev_start) / ts->clock.freq, work, idle);
+#if ARK_PROFILE
+        int ticks = SDL_AtomicGet(&ts->ticks);
+        int live_collectibles = 0;
+        for (int ci = 0; ci < MAX_COLLECTIBLES; ci++) live_collectibles += view->collectibles[ci].alive;
+        prof_frame_end(render_stats.draw_calls, render_stats.quads, view->particles.count, 
+                       live_collectibles, ticks - ticks_seen);
+        ticks_seen = ticks;
+#endif
     }
 
-    if (game_state.show_menu) {
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
-        SDL_Rect full = {0,0,WINDOW_WIDTH,WINDOW_HEIGHT};
-        SDL_RenderFillRect(renderer,&full);
+    SDL_AtomicSet(&sim_link.quit, 1);
+    SDL_WaitThread(ts->thread, NULL);
+    sim_link.active = 0;
+    g->backend = &sdl_backend;
+    g->high_score = view->high_score;
+    fprintf(stderr, "threaded: %d ticks at %d Hz, %d backlog drops\n", 
+            SDL_AtomicGet(&ts->ticks), sim_tick_hz, SDL_AtomicGet(&ts->drops));
+    threaded_free(ts);
+    free(view);
+    return 1;
+}
 
-        SDL_Color titleCol = {255,140,70,255};
-        int titleScale = 10;
-        const char *title = "ARKANOID";
-        int tw = (int)strlen(title) * ((5 * titleScale) + titleScale);
-        int tx = (WINDOW_WIDTH - tw) / 2;
-        int ty = 80;
-        draw_text_pixel(title, tx, ty, titleScale, titleCol);
+/* ========================================================================
+   HEADLESS BATCH SIMULATION
+   - Bot-played games with no window, renderer or mixer, spread over
+     worker threads that each own a Game instance
+   - Usage: arkanoid --headless [--games N] [--threads N] [--max-ticks N]
+                     [--seed N] [--bot-skill 0..1] [--csv FILE]
+   ======================================================================== */
+typedef struct { int game_id; Uint32 seed; int score; int level; int lives; Uint64 ticks; } HeadlessResult;
 
-        SDL_Color scoreCol = {255,80,80,255};
-        int hs_x = WINDOW_WIDTH/2 - 60;
-        draw_text_pixel("HIGH SCORE", hs_x, 18, 2, scoreCol);
-        int label_w = (int)strlen("HIGH SCORE") * (6 * 2);
-        int num_x = hs_x + label_w + 8;
-        draw_number_left(num_x, 18 + 6, 3, high_score, (SDL_Color){255,255,255,255});
+typedef struct {
+    SDL_atomic_t next_game;
+    int num_games;
+    Uint64 max_ticks;
+    Uint32 base_seed;
+    float bot_skill;
+    HeadlessResult *results;
+} HeadlessJob;
 
-        int pw = 220, ph = 72;
-        menu_play_rect.x = (WINDOW_WIDTH - pw)/2; 
-        menu_play_rect.y = ty + 180; 
-        menu_play_rect.w = pw; 
-        menu_play_rect.h = ph;
-        SDL_Rect pr = {(int)menu_play_rect.x, (int)menu_play_rect.y, 
-                       (int)menu_play_rect.w, (int)menu_play_rect.h};
-        SDL_SetRenderDrawColor(renderer, 40,20,90,220);
-        SDL_RenderFillRect(renderer,&pr);
-        draw_text_pixel("PLAY", (int)menu_play_rect.x + 56, (int)menu_play_rect.y + 12, 6, 
-                       (SDL_Color){255,180,200,255});
-        draw_text_pixel("TAP TO START", WINDOW_WIDTH/2 - 70, (int)menu_play_rect.y + ph + 18, 2, 
-                       (SDL_Color){200,200,220,200});
+typedef struct { Uint32 rng; float aim; float last_vy; float skill; } Bot;
 
-        int lb_x = WINDOW_WIDTH/2 - 140;
-        int lb_y = (int)menu_play_rect.y + ph + 60;
-        draw_text_pixel("LEADERBOARD", lb_x, lb_y, 2, (SDL_Color){200,180,240,255});
-        for (int i=0;i<LEADERBOARD_N;i++) {
-            char rankbuf[32];
-            snprintf(rankbuf, sizeof(rankbuf), "%d.", i+1);
-            draw_text_pixel(rankbuf, lb_x, lb_y + 26 + i*22, 2, (SDL_Color){220,220,220,230});
-            int sxpos = lb_x + (int)strlen(rankbuf) * (6*2) + 6;
-            draw_number_left(sxpos, lb_y + 26 + i*22, 2, leaderboard[i], (SDL_Color){255,255,255,255});
+/* Tracks the lowest falling ball with a random aim error drawn each time
+   the tracked ball starts to fall; skill 1 never misses, lower skills miss
+   more often. */
+static void bot_control(Game *g, Bot *bot, float dt) {
+    if (g->balls[0].is_held) { 
+        serve_ball(g); 
+        return; 
+    }
+    const Ball *ball = &g->balls[0];
+    for (int i = 1; i < g->ball_count; i++) {
+        const Ball *b = &g->balls[i];
+        if (b->vy > 0 && (ball->vy <= 0 || b->rect.y > ball->rect.y)) ball = b;
+    }
+    if (ball->vy > 0 && bot->last_vy <= 0) {
+        float u = (float)(xorshift32(&bot->rng) % 2001) / 1000.0f - 1.0f;
+        bot->aim = u * (1.0f - bot->skill) * g->paddle.rect.w;
+    }
+    bot->last_vy = ball->vy;
+    float target = ball->rect.x + ball->rect.w/2.0f + bot->aim;
+    float center = g->paddle.rect.x + g->paddle.rect.w/2.0f;
+    float v = (target - center) / dt;
+    if (v > PADDLE_SPEED) v = PADDLE_SPEED;
+    if (v < -PADDLE_SPEED) v = -PADDLE_SPEED;
+    g->paddle.velocity_x = v;
+}
+
+static int headless_worker(void *data) {
+    HeadlessJob *job = (HeadlessJob *)data;
+    Game *g = (Game *)malloc(sizeof(Game));
+    if (!g) return -1;
+    const float dt = 1.0f / (float)sim_tick_hz;
+    for (;;) {
+        int id = SDL_AtomicAdd(&job->next_game, 1);
+        if (id >= job->num_games) break;
+        Uint32 seed = job->base_seed + (Uint32)id * 2654435761u;
+        init_game(g, &sdl_backend, seed, 1);
+        g->ball_collisions = ball_collisions;
+        reset_game(g);
+        g->game_state.show_menu = 0;
+        Bot bot = { seed ^ 0xA5A5A5A5u, 0.0f, 0.0f, job->bot_skill };
+        if (!bot.rng) bot.rng = 1;
+        Uint64 ticks = 0;
+        while (g->game_state.is_running && ticks < job->max_ticks) {
+            bot_control(g, &bot, dt);
+            g->paddle.rect.x += g->paddle.velocity_x * dt; 
+            clamp_paddle_position(g); 
+            update_engine(g, dt);
+            ticks++;
         }
+        HeadlessResult *res = &job->results[id];
+        res->game_id = id; 
+        res->seed = seed; 
+        res->score = g->game_state.score;
+        res->level = g->game_state.level > MAX_LEVELS ? MAX_LEVELS : g->game_state.level;
+        res->lives = g->game_state.lives; 
+        res->ticks = ticks;
+    }
+    free(g);
+    return 0;
+}
+
+int run_headless(int num_games, int threads, Uint64 max_ticks, Uint32 seed, float skill, const char *csv_path) {
+    if (num_games < 1) num_games = 1;
+    if (threads < 1) threads = SDL_GetCPUCount();
+    if (threads < 1) threads = 1;
+    if (threads > num_games) threads = num_games;
+
+    HeadlessJob job;
+    SDL_AtomicSet(&job.next_game, 0);
+    job.num_games = num_games; 
+    job.max_ticks = max_ticks; 
+    job.base_seed = seed; 
+    job.bot_skill = skill;
+    job.results = (HeadlessResult *)calloc((size_t)num_games, sizeof(HeadlessResult));
+    SDL_Thread **workers = (SDL_Thread **)calloc((size_t)threads, sizeof(SDL_Thread *));
+    if (!job.results || !workers) { 
+        fprintf(stderr, "headless: out of memory\n"); 
+        free(job.results); 
+        free(workers); 
+        return 1; 
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < threads; i++) {
+        workers[i] = SDL_CreateThread(headless_worker, "sim", &job);
+        if (!workers[i]) fprintf(stderr, "headless: thread %d failed: %s\n", i, SDL_GetError());
     }
+    for (int i = 0; i < threads; i++) 
+        if (workers[i]) SDL_WaitThread(workers[i], NULL);
+    double secs = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+    FILE *f = csv_path ? fopen(csv_path, "w") : stdout;
+    if (!f) { 
+        fprintf(stderr, "headless: cannot open %s\n", csv_path); 
+        f = stdout; 
+    }
+    fprintf(f, "game,seed,score,level,lives,ticks\n");
+    Uint64 total_ticks = 0;
+    for (int i = 0; i < num_games; i++) {
+        HeadlessResult *r = &job.results[i];
+        fprintf(f, "%d,%u,%d,%d,%d,%llu\n", r->game_id, (unsigned)r->seed, r->score, r->level, r->lives, 
+                (unsigned long long)r->ticks);
+        total_ticks += r->ticks;
+    }
+    if (f != stdout) fclose(f);
+
+    double tps = secs > 0 ? (double)total_ticks / secs : 0;
+    fprintf(stderr, "headless: %d games, %llu ticks, %.3fs on %d threads: %.0f ticks/s (%.0f per thread)\n",
+            num_games, (unsigned long long)total_ticks, secs, threads, tps, tps / threads);
+    free(workers); 
+    free(job.results);
+    return 0;
 }
 /* ======================================================================== 
-   END: COMPONENT 2 - GRAPHICS & RENDERING
+   END: HEADLESS BATCH SIMULATION
    ======================================================================== */
 
 /* ========================================================================
-   START: COMPONENT 3 - INPUT HANDLING (Member 5 & 6)
+   TRAINING ENVIRONMENTS
+   - SDL thread pool behind the core's ArkEnvRunner, so ark_envs_step
+     spreads its chunks over worker threads plus the calling thread
+   - Usage: arkanoid --env-bench [--envs N] [--threads N] [--steps N] [--seed N]
+     steps every env with a ball-tracking policy and reports env-steps/s
    ======================================================================== */
-void handle_input(SDL_Event *ev) {
-    if (ev->type == SDL_QUIT) { 
-        game_state.is_running = 0; 
+#define ENV_POOL_MAX 64
+
+typedef struct {
+    SDL_Thread *threads[ENV_POOL_MAX];
+    int num_threads;                    /* besides the caller of parallel_for */
+    SDL_sem *go, *done;
+    SDL_atomic_t next, quit;
+    void (*job)(void *ctx, int index);
+    void *ctx;
+    int count;
+} EnvPool;
+
+static void env_pool_drain(EnvPool *p) {
+    for (;;) {
+        int i = SDL_AtomicAdd(&p->next, 1);
+        if (i >= p->count) break;
+        p->job(p->ctx, i);
     }
-    else if (ev->type == SDL_KEYDOWN) {
-        SDL_Keycode k = ev->key.keysym.sym;
-        if (k == SDLK_ESCAPE) { 
-            if (game_state.show_menu) 
-                game_state.is_running = 0; 
-            else 
-                game_state.show_menu = 1; 
+}
+
+static int env_pool_worker(void *data) {
+    EnvPool *p = (EnvPool *)data;
+    for (;;) {
+        SDL_SemWait(p->go);
+        if (SDL_AtomicGet(&p->quit)) break;
+        env_pool_drain(p);
+        SDL_SemPost(p->done);
+    }
+    return 0;
+}
+
+/* the semaphores order the job fields and each job's writes against the caller */
+static void env_pool_parallel_for(void *user, int count, void (*job)(void *ctx, int index), void *ctx) {
+    EnvPool *p = (EnvPool *)user;
+    p->job = job; 
+    p->ctx = ctx; 
+    p->count = count;
+    SDL_AtomicSet(&p->next, 0);
+    for (int i = 0; i < p->num_threads; i++) SDL_SemPost(p->go);
+    env_pool_drain(p);
+    for (int i = 0; i < p->num_threads; i++) SDL_SemWait(p->done);
+}
+
+static int env_pool_init(EnvPool *p, int threads) {
+    memset(p, 0, sizeof(*p));
+    p->go = SDL_CreateSemaphore(0);
+    p->done = SDL_CreateSemaphore(0);
+    if (!p->go || !p->done) return 0;
+    if (threads > ENV_POOL_MAX + 1) threads = ENV_POOL_MAX + 1;
+    for (int i = 0; i < threads - 1; i++) {
+        p->threads[p->num_threads] = SDL_CreateThread(env_pool_worker, "env", p);
+        if (!p->threads[p->num_threads]) {
+            fprintf(stderr, "env: thread %d failed: %s\n", i, SDL_GetError());
+            break;
         }
-        else if (k == SDLK_SPACE) {
-            if (game_state.show_menu) { 
-                game_state.show_menu = 0; 
-                game_state.is_running = 1; 
-                reset_level(game_state.level); 
-                if (music_bgm) Mix_PlayMusic(music_bgm, -1); 
-            }
-            else if (game_state.is_paused) 
-                game_state.is_paused = 0;
-            else if (ball.is_held) { 
-                float ang = ((rand()%120)-60)*(M_PI/180.0f); 
-                ball.vx = sinf(ang); 
-                ball.vy = -fabsf(cosf(ang)); 
-                float m = sqrtf(ball.vx*ball.vx+ball.vy*ball.vy); 
-                ball.vx/=m; 
-                ball.vy/=m; 
-                ball.is_held = 0; 
-            }
-            else 
-                game_state.is_paused = !game_state.is_paused;
+        p->num_threads++;
+    }
+    return 1;
+}
+
+static void env_pool_free(EnvPool *p) {
+    SDL_AtomicSet(&p->quit, 1);
+    for (int i = 0; i < p->num_threads; i++) SDL_SemPost(p->go);
+    for (int i = 0; i < p->num_threads; i++) SDL_WaitThread(p->threads[i], NULL);
+    if (p->go) SDL_DestroySemaphore(p->go);
+    if (p->done) SDL_DestroySemaphore(p->done);
+    memset(p, 0, sizeof(*p));
+}
+
+/* level files and packs only: training runs leave the score files alone */
+static const ArkBackend env_backend = { NULL, sdl_level_cells, NULL, NULL, NULL, NULL };
+
+int run_env_bench(int num_envs, int threads, Uint64 steps, Uint32 seed) {
+    if (num_envs < 1) num_envs = 1;
+    if (threads < 1) threads = SDL_GetCPUCount();
+    if (threads < 1) threads = 1;
+    EnvPool pool;
+    ArkEnvRunner runner = { &pool, env_pool_parallel_for };
+    if (!env_pool_init(&pool, threads)) {
+        fprintf(stderr, "env: %s\n", SDL_GetError());
+        env_pool_free(&pool);
+        return 1;
+    }
+    ArkEnvConfig cfg = { num_envs, seed, sim_tick_hz, 0, 0, ball_collisions, &env_backend, 
+                         pool.num_threads ? &runner : NULL };
+    ArkEnvs *envs = ark_envs_create(&cfg);
+    ArkObs *obs = (ArkObs *)calloc((size_t)num_envs, sizeof(ArkObs));
+    uint8_t *actions = (uint8_t *)calloc((size_t)num_envs, 1);
+    uint64_t *bricks = envs ? (uint64_t *)calloc((size_t)num_envs * envs->brick_words, sizeof(uint64_t)) : NULL;
+    if (!envs || !obs || !actions || !bricks) {
+        fprintf(stderr, "env: out of memory\n");
+        ark_envs_free(envs); 
+        free(obs); 
+        free(actions); 
+        free(bricks);
+        env_pool_free(&pool);
+        return 1;
+    }
+
+    ark_envs_reset(envs, obs, bricks);
+    Uint64 episodes = 0, score_sum = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (Uint64 t = 0; t < steps; t++) {
+        for (int i = 0; i < num_envs; i++) {
+            const ArkObs *o = &obs[i];
+            float target = o->ball[0][0] + BALL_SIZE / 2.0f;
+            float center = o->paddle_x + o->paddle_w / 2.0f;
+            actions[i] = o->held ? ARK_ACT_FIRE : target < center - 8 ? ARK_ACT_LEFT 
+                       : target > center + 8 ? ARK_ACT_RIGHT : ARK_ACT_NOOP;
         }
-        else if (k == SDLK_r) 
-            reset_game();
-        else if (k == SDLK_m) { 
-            if (Mix_PlayingMusic()) 
-                Mix_PausedMusic() ? Mix_ResumeMusic() : Mix_PauseMusic(); 
-            else if (music_bgm) 
-                Mix_PlayMusic(music_bgm, -1); 
+        ark_envs_step(envs, actions, obs, bricks);
+        for (int i = 0; i < num_envs; i++) {
+            if (!obs[i].done && !obs[i].truncated) continue;
+            episodes++;
+            score_sum += (Uint64)obs[i].score;
         }
     }
-    else if (ev->type == SDL_MOUSEMOTION) { 
-        int mx = ev->motion.x; 
-        paddle.rect.x = mx - paddle.rect.w/2; 
-        clamp_paddle_position(); 
+    double secs = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+    double total = (double)steps * num_envs;
+    fprintf(stderr, "env: %d envs x %llu steps on %d threads: %.3fs, %.0f env-steps/s, %llu episodes", 
+            num_envs, (unsigned long long)steps, pool.num_threads + 1, secs, secs > 0 ? total / secs : 0, 
+            (unsigned long long)episodes);
+    if (episodes) fprintf(stderr, ", mean score %.1f", (double)score_sum / (double)episodes);
+    fprintf(stderr, "\n");
+    ark_envs_free(envs);
+    free(obs); 
+    free(actions); 
+    free(bricks);
+    env_pool_free(&pool);
+    return 0;
+}
+/* ======================================================================== 
+   END: TRAINING ENVIRONMENTS
+   ======================================================================== */
+
+/* ========================================================================
+   REPLAY PLAYBACK
+   - Reruns a recorded log (--record FILE) through the fixed-step sim as
+     fast as it will go, with nothing rendered, and checks the result
+     against the footer; exit status 2 on a mismatch
+   - With --render-every N a window shows one frame per N ticks instead,
+     so N sets the fast-forward factor relative to the tick rate
+   - Usage: arkanoid --replay FILE [--render-every N]
+   ======================================================================== */
+static Uint8 *read_whole_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    Uint8 *buf = n > 0 ? (Uint8 *)malloc((size_t)n) : NULL;
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n) { 
+        free(buf); 
+        buf = NULL; 
     }
-    else if (ev->type == SDL_MOUSEBUTTONDOWN) {
-        int mx = ev->button.x, my = ev->button.y;
-        if (game_state.show_menu) {
-            if (mx >= (int)menu_play_rect.x && mx <= (int)(menu_play_rect.x + menu_play_rect.w) && 
-                my >= (int)menu_play_rect.y && my <= (int)(menu_play_rect.y + menu_play_rect.h)) {
-                game_state.show_menu = 0; 
-                game_state.is_running = 1; 
-                reset_level(game_state.level); 
-                if (music_bgm) Mix_PlayMusic(music_bgm, -1);
+    fclose(f);
+    *size = buf ? (size_t)n : 0;
+    return buf;
+}
+
+int run_replay(const char *path, int render_every) {
+    size_t size;
+    Uint8 *data = read_whole_file(path, &size);
+    if (!data) { 
+        fprintf(stderr, "replay: cannot read %s\n", path); 
+        return 1; 
+    }
+    Replay *r = &replay;
+    if (!replay_play_open(r, data, size)) { 
+        free(data); 
+        return 1; 
+    }
+    sim_tick_hz = r->tick_hz;
+    ball_collisions = (r->flags & REPLAY_FLAG_BALL_COLLISIONS) != 0;
+    const float dt = 1.0f / (float)sim_tick_hz;
+    int ok;
+
+    if (render_every <= 0) {
+        Game *g = (Game *)malloc(sizeof(Game));
+        if (!g) { 
+            free(data); 
+            return 1; 
+        }
+        init_game(g, &sdl_backend, r->seed, 1);
+        g->ball_collisions = ball_collisions;
+        reset_game(g);
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        while (replay_play_tick(r, g, game_command)) update_engine(g, dt);
+        double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+        fprintf(stderr, "replay: %llu ticks in %.3fs (%.0fx real time)\n", (unsigned long long)r->ticks, secs, 
+                secs > 0 ? (double)r->ticks / sim_tick_hz / secs : 0.0);
+        ok = replay_play_verify(r, g);
+        free(g);
+    } else {
+        Game *g = &game;
+        if (!initialize_all(g, r->seed)) { 
+            free(data); 
+            return 1; 
+        }
+        reset_game(g);
+        pacer_init(&pacer, window);
+        int watching = 1, more = 1;
+        SDL_Event ev;
+        while (watching && more) {
+            while (SDL_PollEvent(&ev)) 
+                if (ev.type == SDL_QUIT || (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_ESCAPE)) watching = 0;
+            assets_poll(g);
+            for (int i = 0; i < render_every && more; i++) {
+                snap_interpolation_state(g);
+                more = replay_play_tick(r, g, game_command);
+                if (more) update_engine(g, dt);
             }
+            audio_submit(g);
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND); 
+            render_scene(g, 1.0f);
+            SDL_RenderPresent(renderer);
+            pacer_wait(&pacer, 0);
         }
+        ok = !more && replay_play_verify(r, g);
+        if (more) fprintf(stderr, "replay: stopped at tick %llu\n", (unsigned long long)r->ticks);
+        cleanup_all(g);
     }
+    free(data);
+    return ok ? 0 : 2;
 }
 /* ======================================================================== 
-   END: COMPONENT 3 - INPUT HANDLING
+   END: REPLAY PLAYBACK
    ======================================================================== */
 
 /* ========================================================================
-   START: COMPONENT 2 - GRAPHICS & RENDERING (Member 3 & 4)
+   SPECTATOR VIEWER
+   - Rebuilds a Game from a --spectate stream and draws it with
+     render_scene, interpolating between the last two ticks applied
+   - A reader thread queues packets. The main thread applies them in tick
+     order on the stream's own clock, so a recorded stream plays back in
+     real time and a live one runs at most SPEC_MAX_LAG behind
+   - Deltas apply only in an unbroken sequence from a key; after a gap
+     the last frame holds until the next key
+   - Usage: arkanoid --spectate-view SOURCE, where SOURCE is
+     udp:HOST:PORT to listen on (HOST may be empty) or a path, - for stdin
    ======================================================================== */
-int init_color_palette() { 
-    color_palette[0]=(SDL_Color){255,120,120,255}; 
-    color_palette[1]=(SDL_Color){255,200,80,255}; 
-    color_palette[2]=(SDL_Color){110,255,170,255}; 
-    color_palette[3]=(SDL_Color){90,160,255,255}; 
-    color_palette[4]=(SDL_Color){210,90,200,255}; 
-    color_palette[5]=(SDL_Color){120,200,255,255}; 
-    color_palette[6]=(SDL_Color){255,150,60,255}; 
-    color_palette[7]=(SDL_Color){170,120,255,255}; 
-    color_palette[8]=(SDL_Color){160,255,200,255}; 
-    color_palette[9]=(SDL_Color){255,100,180,255}; 
-    return 1; 
+#define SPEC_MAX_LAG 0.25           /* seconds */
+
+typedef struct {
+    SpecLink link;
+    SpecQueue queue;
+    SDL_atomic_t quit, eof;
+    Uint8 discard[SPEC_PACKET_MAX];
+} SpecReader;
+
+static int spec_reader_main(void *arg) {
+    SpecReader *r = (SpecReader *)arg;
+    while (!SDL_AtomicGet(&r->quit)) {
+        SpecPacket *p = spec_queue_back(&r->queue);
+        /* a pipe or file waits for room; UDP reads on and drops */
+        if (!p && r->link.f) { 
+            SDL_Delay(1); 
+            continue; 
+        }
+        int n = spec_link_recv(&r->link, p ? p->data : r->discard);
+        if (n < 0) break;
+        if (n == 0 || !p) continue;
+        p->len = (Uint16)n;
+        spec_queue_push(&r->queue);
+    }
+    SDL_AtomicSet(&r->eof, 1);
+    return 0;
+}
+
+typedef struct {
+    Game *view;
+    SpecState cur, next;        /* applied, and decoded but not yet due */
+    int synced, pending;
+    Uint16 seq;                 /* of the last packet taken */
+    int tick_hz;
+    Uint32 deaths[SPEC_DEATHS_MAX];
+    int death_count;
+    Uint32 death_serial;
+    Uint32 clock_base;          /* stream tick at clock_pc */
+    Uint64 clock_pc;
+    Uint64 applied, gaps;
+} SpecView;
+
+static double spec_view_clock(const SpecView *v, Uint64 now) {
+    return v->clock_base + (double)(now - v->clock_pc) * v->tick_hz / (double)SDL_GetPerformanceFrequency();
+}
+
+static void spec_view_board(SpecView *v, BitBuf *b) {
+    Board *bd = &v->view->board;
+    Uint32 serial = bits_get(b, 16);
+    int rows = (int)bits_get(b, 9), cols = (int)bits_get(b, 9);
+    int first = (int)bits_get(b, SPEC_CELL_BITS), count = (int)bits_get(b, 11);
+    if (b->overflow || rows < 1 || cols < 1 || rows > BOARD_MAX_ROWS || cols > BOARD_MAX_COLS) return;
+    if (bd->serial != serial || bd->rows != rows || bd->cols != cols) {
+        board_layout(bd, rows, cols);
+        bd->serial = serial;
+    }
+    if (first + count > rows * cols) return;
+    for (int i = first; i < first + count; i++) {
+        int alive = (int)bits_get(b, 1);
+        int color = alive ? (int)bits_get(b, 4) : 0;
+        if (alive) board_set_alive(bd, i);
+        else bd->alive[i >> 6] &= ~(1ull << (i & 63));
+        bd->cells[i] = (Uint8)(color << 4 | (alive ? LEVEL_CELL_BRICK : LEVEL_CELL_EMPTY));
+    }
+    bd->dirty_all = 1;
+}
+
+static void spec_view_commit(SpecView *v) {
+    Game *g = v->view;
+    const SpecState *s = &v->next;
+    g->paddle_prev_rect = g->paddle.rect;
+    for (int i = 0; i < s->ball_count; i++) 
+        g->ball_prev_rect[i] = i < g->ball_count ? g->balls[i].rect : (RectF){ spec_unpos(s->balls[i].x), 
+                               spec_unpos(s->balls[i].y), BALL_SIZE, BALL_SIZE };
+    g->paddle.rect.x = spec_unpos(s->paddle_x);
+    g->paddle.rect.w = spec_unpos(s->paddle_w);
+    g->ball_count = s->ball_count;
+    for (int i = 0; i < s->ball_count; i++) {
+        Ball *b = &g->balls[i];
+        b->rect = (RectF){ spec_unpos(s->balls[i].x), spec_unpos(s->balls[i].y), BALL_SIZE, BALL_SIZE };
+        b->is_held = s->balls[i].held;
+    }
+    for (int i = 0; i < MAX_COLLECTIBLES; i++) {
+        Collectible *c = &g->collectibles[i];
+        c->alive = s->collect_alive >> i & 1;
+        c->rect = (RectF){ spec_unpos(s->collect_x[i]), spec_unpos(s->collect_y[i]), 20, 20 };
+        c->type = s->collect_type[i];
+    }
+    GameState *gs = &g->game_state;
+    gs->score = s->score; 
+    gs->lives = s->lives; 
+    gs->level = s->level;
+    gs->bricks_remaining = s->bricks_remaining;
+    gs->is_paused = s->flags & 1; 
+    gs->is_running = s->flags >> 1 & 1; 
+    gs->show_menu = s->flags >> 2 & 1;
+    g->high_score = s->high_score;
+
+    Board *bd = &g->board;
+    if (v->death_count && v->death_serial == (bd->serial & 0xFFFF)) {
+        for (int i = 0; i < v->death_count; i++) {
+            Uint32 d = v->deaths[i];
+            if ((int)d >= bd->rows * bd->cols) continue;
+            bd->alive[d >> 6] &= ~(1ull << (d & 63));
+            if (bd->dirty_count < BOARD_DIRTY_MAX) bd->dirty[bd->dirty_count++] = d;
+            else bd->dirty_all = 1;
+        }
+    }
+    v->cur = v->next;
+    v->pending = 0;
+    v->applied++;
+}
+
+/* Takes one queued packet: a board chunk applies at once, a key or delta
+   becomes v->next. */
+static void spec_view_take(SpecView *v, const SpecPacket *p) {
+    BitBuf b = { (Uint8 *)p->data, p->len * 8, 0, 0 };
+    Uint32 tag = bits_get(&b, 8);
+    Uint16 seq = (Uint16)bits_get(&b, 16);
+    int type = (int)(tag & 0xF);
+    if (b.overflow || (tag & 0xF0) != SPEC_MAGIC) return;
+    int in_order = v->synced && seq == (Uint16)(v->seq + 1);
+    v->seq = seq;
+    if (type == SPEC_BOARD) {
+        spec_view_board(v, &b);
+        return;
+    }
+    if (type != SPEC_KEY && !in_order) {
+        if (v->synced) v->gaps++;
+        v->synced = 0;
+        return;
+    }
+    b.pos = 0;
+    int hz = v->tick_hz;
+    if (!spec_decode(&b, &v->next, &v->cur, &hz, &v->death_serial, v->deaths, &v->death_count)) {
+        v->synced = 0;
+        return;
+    }
+    if (type == SPEC_KEY && hz >= SIM_MIN_TICK_HZ && hz <= SIM_MAX_TICK_HZ) v->tick_hz = hz;
+    v->synced = 1;
+    v->pending = 1;
+}
+
+/* Applies everything due by now. Returns the interpolation fraction. */
+static float spec_view_update(SpecView *v, SpecQueue *q, Uint64 now) {
+    for (;;) {
+        if (!v->pending) {
+            SpecPacket *p = spec_queue_front(q);
+            if (!p) break;
+            spec_view_take(v, p);
+            spec_queue_pop(q);
+            continue;
+        }
+        double clock = spec_view_clock(v, now);
+        double lag = SPEC_MAX_LAG * v->tick_hz;
+        if (v->applied == 0 || fabs((double)v->next.tick - clock) > lag) {
+            v->clock_base = v->next.tick;   /* first frame, or drifted: resync */
+            v->clock_pc = now;
+            clock = v->next.tick;
+        }
+        if ((double)v->next.tick > clock) break;
+        spec_view_commit(v);
+    }
+    if (!v->applied) return 1.0f;
+    double alpha = spec_view_clock(v, now) - v->cur.tick;
+    return (float)(alpha < 0 ? 0 : alpha > 1 ? 1 : alpha);
+}
+
+int run_spectate_view(const char *source) {
+    SpecReader *rd = (SpecReader *)calloc(1, sizeof(SpecReader));
+    SpecView *sv = (SpecView *)calloc(1, sizeof(SpecView));
+    Game *view = (Game *)malloc(sizeof(Game));
+    if (!rd || !sv || !view || !spec_link_open(&rd->link, source, 0)) {
+        free(rd); 
+        free(sv); 
+        free(view);
+        return 1;
+    }
+    Game *g = &game;
+    if (!initialize_all(g, 0)) {
+        spec_link_close(&rd->link);
+        free(rd); 
+        free(sv); 
+        free(view);
+        return 1;
+    }
+    init_game(view, NULL, 0, 0);
+    /* the stream carries only the paddle's x and width; its row is fixed */
+    view->paddle.rect.y = WINDOW_HEIGHT - PADDLE_Y_OFFSET;
+    view->game_state.show_menu = 1;
+    sv->view = view;
+    sv->tick_hz = sim_tick_hz;
+    SDL_Thread *reader = SDL_CreateThread(spec_reader_main, "spectate", rd);
+    if (!reader) fprintf(stderr, "spectate: reader thread failed: %s\n", SDL_GetError());
+
+    pacer_init(&pacer, window);
+    int watching = reader != NULL;
+    SDL_Event ev;
+    while (watching) {
+        while (SDL_PollEvent(&ev)) 
+            if (ev.type == SDL_QUIT || (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_ESCAPE)) watching = 0;
+        assets_poll(g);
+        float alpha = spec_view_update(sv, &rd->queue, SDL_GetPerformanceCounter());
+        if (SDL_AtomicGet(&rd->eof) && !sv->pending && !spec_queue_front(&rd->queue)) watching = 0;
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND); 
+        render_scene(view, alpha);
+        SDL_RenderPresent(renderer);
+        pacer_wait(&pacer, 0);
+    }
+    SDL_AtomicSet(&rd->quit, 1);
+    /* a reader blocked on a quiet pipe can't be woken; it goes with the process */
+    int detached = reader && rd->link.f && !SDL_AtomicGet(&rd->eof);
+    if (detached) SDL_DetachThread(reader);
+    else if (reader) SDL_WaitThread(reader, NULL);
+    fprintf(stderr, "spectate: %llu ticks shown, %llu gaps\n", (unsigned long long)sv->applied, 
+            (unsigned long long)sv->gaps);
+    cleanup_all(g);
+    if (!detached) {
+        spec_link_close(&rd->link);
+        free(rd);
+    }
+    free(sv);
+    free(view);
+    return 0;
 }
 /* ======================================================================== 
-   END: COMPONENT 2 - GRAPHICS & RENDERING
+   END: SPECTATOR VIEWER
    ======================================================================== */
 
 /* ========================================================================
-   START: COMPONENT 5 - SOUND, UI & MENU SYSTEM (Member 9 & 10)
+   BENCHMARKS
+   - Hot-path timings for comparing changes against a baseline: engine
+     ticks on scripted boards up to a full 256x256 one, particle spawn/update, render_scene into an
+     offscreen software renderer, level loading, leaderboard insert/page
+     and the persistence commits
+   - Every case runs warmup samples first, then reports the median, p99,
+     min and max of its samples; boards and seeds are fixed, so two runs
+     on one machine do the same work
+   - Usage: arkanoid --bench [--bench-samples N] [--csv FILE]
+     (CSV: name,unit,samples,median,p99,min,max,note)
    ======================================================================== */
-int load_audio_assets() { 
-    sfx_bounce = Mix_LoadWAV("bounce_real.wav"); 
-    sfx_break = Mix_LoadWAV("break_real.wav"); 
-    music_bgm = Mix_LoadMUS("bgm_arcade.wav"); 
-    return 1; 
+#define BENCH_WARMUP 5
+#define BENCH_TICKS 4000            /* engine ticks per sample */
+#define BENCH_LB_INSERTS 10000      /* leaderboard inserts per sample */
+#define BENCH_HIGH_SCORE_FILE "bench_highscore.dat"
+#define BENCH_SCORES_LOG "bench_scores.log"
+#define BENCH_SCORES_SNAPSHOT "bench_scores.snap"
+
+typedef enum { BOARD_FULL, BOARD_SPARSE, BOARD_NEAR_EMPTY, BOARD_MEGA } BenchBoard;
+
+typedef struct {
+    int samples;
+    double *v;                  /* samples of the running case */
+    FILE *csv;
+    double freq;
+} Bench;
+
+static inline double bench_ns(const Bench *b, Uint64 t0) {
+    return (double)(SDL_GetPerformanceCounter() - t0) * 1e9 / b->freq;
 }
 
-int initialize_all() {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER) != 0) { 
-        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError()); 
-        return 0; 
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_report(Bench *b, const char *name, const char *unit, const char *note) {
+    int n = b->samples;
+    qsort(b->v, (size_t)n, sizeof(double), cmp_double);
+    double median = n & 1 ? b->v[n / 2] : 0.5 * (b->v[n / 2 - 1] + b->v[n / 2]);
+    int p = (int)ceil(0.99 * n) - 1;
+    double p99 = b->v[p < 0 ? 0 : p];
+    fprintf(stderr, "%-22s %12.1f %12.1f %-12s %s\n", name, median, p99, unit, note ? note : "");
+    if (b->csv) 
+        fprintf(b->csv, "%s,%s,%d,%.1f,%.1f,%.1f,%.1f,%s\n", name, unit, n, median, p99, 
+                b->v[0], b->v[n - 1], note ? note : "");
+}
+
+/* Replaces the level layout with a scripted one and puts the game in play.
+   BOARD_MEGA is the largest grid the core allows, every cell filled. */
+static void bench_board(Game *g, BenchBoard board) {
+    Board *bd = &g->board;
+    if (board == BOARD_MEGA) board_layout(bd, BOARD_MAX_ROWS, BOARD_MAX_COLS);
+    else board_layout(bd, BRICK_ROWS, BRICK_COLUMNS);
+    for (int i = 0; i < bd->rows * bd->cols; i++) {
+        int alive = board == BOARD_FULL || board == BOARD_MEGA ? 1 : 
+                    board == BOARD_SPARSE ? i % 4 == 0 : i == 0 || i == bd->cols - 1;
+        bd->cells[i] = (Uint8)(LEVEL_CELL_BRICK | (i % 10) << 4);
+        if (alive) bd->alive[i >> 6] |= 1ull << (i & 63);
     }
-    window = SDL_CreateWindow("Arkanoid - Final", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 
-                              WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
-    if (!window) { 
-        fprintf(stderr, "Window create fail: %s\n", SDL_GetError()); 
-        return 0; 
+    g->game_state.bricks_remaining = board_alive_count(bd);
+    g->game_state.show_menu = 0;
+}
+
+static void bench_engine(Bench *b, Game *g, BenchBoard board, const char *name) {
+    const float dt = 1.0f / (float)sim_tick_hz;
+    Uint64 ticks = 0, bricks = 0;
+    for (int s = -BENCH_WARMUP; s < b->samples; s++) {
+        init_game(g, &sdl_backend, 1234, 1);
+        g->ball_collisions = ball_collisions;
+        reset_game(g);
+        bench_board(g, board);
+        int start_bricks = g->game_state.bricks_remaining;
+        Bot bot = { 0xA5A5A5A5u, 0.0f, 0.0f, 1.0f };
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        for (int t = 0; t < BENCH_TICKS; t++) {
+            bot_control(g, &bot, dt);
+            ark_tick(g, dt);
+        }
+        double ns = bench_ns(b, t0);
+        if (s < 0) continue;
+        b->v[s] = ns / BENCH_TICKS;
+        ticks += BENCH_TICKS;
+        bricks += (Uint64)(start_bricks - g->game_state.bricks_remaining);
     }
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!renderer) { 
-        fprintf(stderr, "Renderer fail: %s\n", SDL_GetError()); 
-        return 0; 
+    char note[64];
+    snprintf(note, sizeof(note), "%.1f bricks broken per sample", (double)bricks / b->samples);
+    bench_report(b, name, "ns/tick", note);
+}
+
+static void bench_particles(Bench *b, Game *g) {
+    static const int loads[] = { 1024, 16384, MAX_PARTICLES };
+    init_game(g, &sdl_backend, 1234, 0);
+    if (!particles_init(&g->particles, MAX_PARTICLES)) { 
+        fprintf(stderr, "bench: particle pool alloc fail\n"); 
+        return; 
     }
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) < 0) { 
-        fprintf(stderr, "Mix_OpenAudio fail: %s\n", Mix_GetError()); 
+    double *update = (double *)malloc((size_t)b->samples * sizeof(double));
+    if (!update) { 
+        particles_free(&g->particles); 
+        return; 
+    }
+    for (size_t l = 0; l < sizeof(loads) / sizeof(loads[0]); l++) {
+        int n = loads[l];
+        for (int s = -BENCH_WARMUP; s < b->samples; s++) {
+            g->particles.count = 0;
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            spawn_particles(g, WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f, 0, n);
+            double spawn_ns = bench_ns(b, t0);
+            t0 = SDL_GetPerformanceCounter();
+            update_particles(g, 1.0f / (float)sim_tick_hz);
+            double update_ns = bench_ns(b, t0);
+            if (s < 0) continue;
+            b->v[s] = spawn_ns / n;
+            update[s] = update_ns / n;
+        }
+        char name[32], note[32];
+        snprintf(note, sizeof(note), "%d live", n);
+        snprintf(name, sizeof(name), "particles/spawn/%d", n);
+        bench_report(b, name, "ns/particle", note);
+        memcpy(b->v, update, (size_t)b->samples * sizeof(double));
+        snprintf(name, sizeof(name), "particles/update/%d", n);
+        bench_report(b, name, "ns/particle", note);
+    }
+    free(update);
+    particles_free(&g->particles);
+}
+
+/* render_scene into a software renderer on a plain surface: no window or
+   GPU, so the numbers measure the CPU side of building a frame. */
+static void bench_render(Bench *b, Game *g) {
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) { 
+        fprintf(stderr, "bench: software renderer fail: %s\n", SDL_GetError()); 
+        if (surface) SDL_FreeSurface(surface); 
+        return; 
     }
     init_color_palette();
-    paddle.rect.w = PADDLE_WIDTH; 
-    paddle.rect.h = PADDLE_HEIGHT; 
-    paddle.velocity_x = 0; 
-    ball.rect.w = BALL_SIZE; 
-    ball.rect.h = BALL_SIZE;
-    srand((unsigned)time(NULL)); 
-    spawn_stars(); 
-    load_audio_assets();
-    load_highscore(); 
-    load_leaderboard();
-    for (int i = 0; i < MAX_PARTICLES; i++) 
-        particles[i].alive = 0;
-    for (int i = 0; i < MAX_COLLECTIBLES; i++) 
-        collectibles[i].alive = 0;
-    return 1;
+    sprite_atlas_init();
+    hud_cache_init();
+    background_cache_init();
+    brick_layer_init();
+    init_game(g, &sdl_backend, 1234, 0);
+    if (!particles_init(&g->particles, MAX_PARTICLES)) 
+        fprintf(stderr, "bench: particle pool alloc fail\n");
+    assets_ready = 1;
+    QualityGovernor saved = quality;
+    /* play and menu at full quality, then play at the lowest tier */
+    for (int pass = 0; pass < 3; pass++) {
+        int menu = pass == 1;
+        quality_pin(pass == 2 ? QUALITY_TIER_COUNT - 1 : 0);
+        reset_game(g);
+        bench_board(g, BOARD_FULL);
+        g->game_state.show_menu = menu;
+        g->fx_density = quality_tier()->particle_pct;
+        spawn_particles(g, WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f, 0, 2048);
+        for (int s = -BENCH_WARMUP; s < b->samples; s++) {
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND); 
+            render_scene(g, 1.0f);
+            SDL_RenderPresent(renderer);
+            double ns = bench_ns(b, t0);
+            if (s >= 0) b->v[s] = ns / 1000.0;
+        }
+        char note[64];
+        snprintf(note, sizeof(note), "%d draw calls %d quads", render_stats.draw_calls, render_stats.quads);
+        bench_report(b, pass == 2 ? "render/play-low" : menu ? "render/menu" : "render/play", "us/frame", note);
+    }
+    quality = saved;
+    assets_ready = 0;
+    particles_free(&g->particles);
+    batch_free();
+    sprite_atlas_free();
+    background_cache_free();
+    brick_layer_free();
+    SDL_DestroyRenderer(renderer);
+    renderer = NULL;
+    SDL_FreeSurface(surface);
 }
 
-void cleanup_all() {
-    if (game_state.score > high_score) { 
-        high_score = game_state.score; 
-        save_highscore(); 
+static void bench_levels(Bench *b, Game *g) {
+    init_game(g, &sdl_backend, 1234, 1);
+    for (int s = -BENCH_WARMUP; s < b->samples; s++) {
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        for (int lv = 1; lv <= MAX_LEVELS; lv++) reset_level(g, lv);
+        double ns = bench_ns(b, t0);
+        if (s >= 0) b->v[s] = ns / MAX_LEVELS;
     }
-    if (sfx_bounce) Mix_FreeChunk(sfx_bounce); 
-    if (sfx_break) Mix_FreeChunk(sfx_break); 
-    if (music_bgm) Mix_FreeMusic(music_bgm);
-    Mix_CloseAudio();
-    if (renderer) SDL_DestroyRenderer(renderer);
-    if (window) SDL_DestroyWindow(window);
+    bench_report(b, "level/load", "ns/level", level_pack.data ? "from " LEVEL_PACK_FILE : "text files or built-in");
+}
+
+static void bench_leaderboard(Bench *b) {
+    double *page = (double *)malloc((size_t)b->samples * sizeof(double));
+    if (!page) return;
+    for (int s = -BENCH_WARMUP; s < b->samples; s++) {
+        Leaderboard lb;
+        memset(&lb, 0, sizeof(lb));
+        Uint32 rng = 99;
+        ScoreRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        for (int i = 0; i < BENCH_LB_INSERTS; i++) {
+            rec.score = (Sint32)(xorshift32(&rng) % 100000);
+            rec.day = 20000 + i % 30;
+            rec.level = (Uint16)(1 + i % MAX_LEVELS);
+            memcpy(rec.initials, i & 1 ? "AAA" : "BBB", 4);
+            rec.check = score_record_check(&rec);
+            lb_insert(&lb, &rec);
+        }
+        double insert_ns = bench_ns(b, t0);
+        const ScoreRecord *rows[LEADERBOARD_N];
+        int total;
+        t0 = SDL_GetPerformanceCounter();
+        lb_page(&lb, LB_ALL, 0, 0, LEADERBOARD_N, rows, &total);   /* first read after inserts re-sorts */
+        double page_ns = bench_ns(b, t0);
+        lb_free(&lb);
+        if (s < 0) continue;
+        b->v[s] = insert_ns / BENCH_LB_INSERTS;
+        page[s] = page_ns / 1000.0;
+    }
+    bench_report(b, "leaderboard/insert", "ns/record", NULL);
+    memcpy(b->v, page, (size_t)b->samples * sizeof(double));
+    bench_report(b, "leaderboard/page", "us/page", "after inserts");
+    free(page);
+}
+
+/* The write-behind thread's commits, run inline against scratch files. */
+static void bench_persist(Bench *b) {
+    const char *hs_file = HIGH_SCORE_FILE, *log_file = SCORES_LOG_FILE, *snap_file = SCORES_SNAPSHOT_FILE;
+    HIGH_SCORE_FILE = BENCH_HIGH_SCORE_FILE;
+    SCORES_LOG_FILE = BENCH_SCORES_LOG;
+    SCORES_SNAPSHOT_FILE = BENCH_SCORES_SNAPSHOT;
+    static ScoreRecord recs[LB_TOP_K];
+    for (int i = 0; i < LB_TOP_K; i++) {
+        memset(&recs[i], 0, sizeof(recs[i]));
+        recs[i].score = 1234 + i;
+        memcpy(recs[i].initials, "BEN", 4);
+        recs[i].check = score_record_check(&recs[i]);
+    }
+    ScoreSnapshot snap = { recs, LB_TOP_K, 0 };
+    static const Uint32 kinds[] = { PERSIST_HIGHSCORE, PERSIST_RECORDS, PERSIST_SNAPSHOT };
+    static const char *names[] = { "persist/high_score", "persist/record", "persist/snapshot" };
+    for (int k = 0; k < 3; k++) {
+        for (int s = -BENCH_WARMUP; s < b->samples; s++) {
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            persist_commit(kinds[k], s, recs, 1, &snap);
+            double ns = bench_ns(b, t0);
+            if (s >= 0) b->v[s] = ns / 1000.0;
+        }
+        bench_report(b, names[k], "us/commit", k == 2 ? "fsync'd, top-K records" : "fsync'd");
+    }
+    remove(BENCH_HIGH_SCORE_FILE);
+    remove(BENCH_SCORES_LOG);
+    remove(BENCH_SCORES_SNAPSHOT);
+    HIGH_SCORE_FILE = hs_file;
+    SCORES_LOG_FILE = log_file;
+    SCORES_SNAPSHOT_FILE = snap_file;
+}
+
+int run_bench(int samples, const char *csv_path) {
+    if (samples < 1) samples = 1;
+    if (SDL_Init(SDL_INIT_TIMER) != 0) { 
+        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError()); 
+        return 1; 
+    }
+    Bench b;
+    b.samples = samples;
+    b.freq = (double)SDL_GetPerformanceFrequency();
+    b.v = (double *)malloc((size_t)samples * sizeof(double));
+    Game *g = (Game *)malloc(sizeof(Game));
+    b.csv = csv_path ? fopen(csv_path, "w") : NULL;
+    if (!b.v || !g || (csv_path && !b.csv)) { 
+        fprintf(stderr, "bench: %s\n", csv_path && !b.csv ? "cannot open CSV file" : "out of memory"); 
+        free(b.v); 
+        free(g); 
+        SDL_Quit(); 
+        return 1; 
+    }
+    if (b.csv) fprintf(b.csv, "name,unit,samples,median,p99,min,max,note\n");
+    fprintf(stderr, "bench: %d samples per case after %d warmup, tick rate %d Hz%s\n", samples, BENCH_WARMUP, 
+            sim_tick_hz, ball_collisions ? ", ball collisions" : "");
+    fprintf(stderr, "%-22s %12s %12s %-12s %s\n", "case", "median", "p99", "unit", "note");
+    bench_engine(&b, g, BOARD_FULL, "engine/full");
+    bench_engine(&b, g, BOARD_SPARSE, "engine/sparse");
+    bench_engine(&b, g, BOARD_NEAR_EMPTY, "engine/near_empty");
+    bench_engine(&b, g, BOARD_MEGA, "engine/mega");
+    bench_particles(&b, g);
+    bench_render(&b, g);
+    bench_levels(&b, g);
+    bench_leaderboard(&b);
+    bench_persist(&b);
+    if (b.csv) fclose(b.csv);
+    free(b.v);
+    free(g);
     SDL_Quit();
+    return 0;
 }
 /* ======================================================================== 
-   END: COMPONENT 5 - SOUND, UI & MENU SYSTEM
+   END: BENCHMARKS
    ======================================================================== */
 
 /* ========================================================================
@@ -925,41 +4795,191 @@ void cleanup_all() {
    - COMPONENT 1: Game engine updates (update_engine)
    - COMPONENT 2: Rendering (render_scene)
    ======================================================================== */
+/* Teardown for main's game session; closes whatever it got as far as opening. */
+static void end_session(Game *g) {
+    replay_record_close(&replay);
+    spectate_close(&spec_out);
+    cleanup_all(g);
+    level_pack_close();
+}
+
 int main(int argc, char *argv[]) {
-    (void)argc; (void)argv;
-    if (!initialize_all()) return 1;
-    paddle.rect.w = PADDLE_WIDTH; 
-    paddle.rect.h = PADDLE_HEIGHT; 
-    paddle.velocity_x = 0; 
-    ball.rect.w = BALL_SIZE; 
-    ball.rect.h = BALL_SIZE; 
-    reset_game();
+    int headless = 0, games = 64, threads = 0;
+    int env_bench = 0, num_envs = 256;
+    Uint64 env_steps = 10000;
+    Uint64 max_ticks = 10000000ull;
+    Uint32 seed = (Uint32)time(NULL);
+    float skill = 0.4f;
+    const char *csv_path = NULL;
+    const char *record_path = NULL, *replay_path = NULL;
+    const char *spectate_target = NULL, *spectate_source = NULL;
+    int render_every = 0;
+    int bench = 0, bench_samples = 51;
+    int threaded = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            sim_tick_hz = atoi(argv[++i]);
+            if (sim_tick_hz < SIM_MIN_TICK_HZ) sim_tick_hz = SIM_MIN_TICK_HZ;
+            if (sim_tick_hz > SIM_MAX_TICK_HZ) sim_tick_hz = SIM_MAX_TICK_HZ;
+        }
+        else if (strcmp(argv[i], "--headless") == 0) headless = 1;
+        else if (strcmp(argv[i], "--threaded") == 0) threaded = 1;
+        else if (strcmp(argv[i], "--env-bench") == 0) env_bench = 1;
+        else if (strcmp(argv[i], "--envs") == 0 && i + 1 < argc) num_envs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) env_steps = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--bench") == 0) bench = 1;
+        else if (strcmp(argv[i], "--bench-samples") == 0 && i + 1 < argc) bench_samples = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) max_ticks = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (Uint32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--bot-skill") == 0 && i + 1 < argc) skill = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csv_path = argv[++i];
+        else if (strcmp(argv[i], "--pace") == 0 && i + 1 < argc) {
+            int m = pace_mode_from_name(argv[++i]);
+            if (m < 0) { 
+                fprintf(stderr, "unknown pace mode '%s' (vsync, uncapped, cap, powersave)\n", argv[i]); 
+                return 1; 
+            }
+            pacer.mode = (PaceMode)m;
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            pacer.cap_fps = atoi(argv[++i]);
+            if (pacer.mode == PACE_VSYNC) pacer.mode = PACE_CAP;
+        }
+        else if (strcmp(argv[i], "--no-late-latch") == 0) input_latch.late_latch = 0;
+        else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) quality_pin(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--ball-collisions") == 0) ball_collisions = 1;
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) record_path = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replay_path = argv[++i];
+        else if (strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) spectate_target = argv[++i];
+        else if (strcmp(argv[i], "--spectate-view") == 0 && i + 1 < argc) spectate_source = argv[++i];
+        else if (strcmp(argv[i], "--render-every") == 0 && i + 1 < argc) render_every = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            size_t len = strlen(name);
+            for (size_t c = 0; c < 3; c++) {
+                char ch = c < len ? (char)toupper((unsigned char)name[c]) : ' ';
+                player_initials[c] = isalnum((unsigned char)ch) ? ch : ' ';
+            }
+        }
+        else if (strcmp(argv[i], "--compile-levels") == 0) 
+            return compile_level_pack(i + 1 < argc ? argv[i + 1] : LEVEL_PACK_FILE) ? 0 : 1;
+    }
+    level_pack_open(LEVEL_PACK_FILE);
+    if (headless) {
+        int rc = run_headless(games, threads, max_ticks, seed, skill, csv_path);
+        level_pack_close();
+        return rc;
+    }
+    if (env_bench) {
+        int rc = run_env_bench(num_envs, threads, env_steps, seed);
+        level_pack_close();
+        return rc;
+    }
+    if (bench) {
+        int rc = run_bench(bench_samples, csv_path);
+        level_pack_close();
+        return rc;
+    }
+    if (replay_path) {
+        int rc = run_replay(replay_path, render_every);
+        level_pack_close();
+        return rc;
+    }
+    if (spectate_source) {
+        int rc = run_spectate_view(spectate_source);
+        level_pack_close();
+        return rc;
+    }
+
+    Game *g = &game;
+    if (!initialize_all(g, seed)) return 1;
+    if (record_path && !replay_record_open(&replay, record_path, seed)) { 
+        end_session(g); 
+        return 1; 
+    }
+    if (spectate_target && !spectate_open(&spec_out, spectate_target)) { 
+        end_session(g); 
+        return 1; 
+    }
+    reset_game(g);
+    const double tick_dt = 1.0 / (double)sim_tick_hz;
     Uint64 now = SDL_GetPerformanceCounter(); 
     Uint64 last = 0; 
-    double delta_time = 0; 
+    double frame_time = 0; 
+    double accumulator = 0;
     SDL_Event ev;
-    while (game_state.is_running) {
+    pacer_init(&pacer, window);
+#if ARK_PROFILE
+    prof_init();
+#endif
+    int ran_threaded = threaded && run_threaded(g);
+    while (!ran_threaded && g->game_state.is_running) {
+#if ARK_PROFILE
+        prof_frame_begin();
+#endif
         last = now; 
         now = SDL_GetPerformanceCounter(); 
-        delta_time = (double)((now - last) / (double)SDL_GetPerformanceFrequency()); 
-        if (delta_time > 0.05) delta_time = 0.05;
+        frame_time = (double)((now - last) / (double)SDL_GetPerformanceFrequency()); 
+        if (frame_time > SIM_MAX_FRAME_TIME) frame_time = SIM_MAX_FRAME_TIME;
+        accumulator += frame_time;
         
-        while (SDL_PollEvent(&ev)) handle_input(&ev);
+        PROF_BEGIN(PROF_INPUT);
+        while (SDL_PollEvent(&ev)) handle_input(g, &ev);
+        assets_poll(g);
+        apply_mouse_sample(g);
         
         const Uint8 *ks = SDL_GetKeyboardState(NULL); 
-        float vx = 0.0f; 
-        if (ks[SDL_SCANCODE_LEFT] || ks[SDL_SCANCODE_A]) vx = -PADDLE_SPEED; 
-        if (ks[SDL_SCANCODE_RIGHT] || ks[SDL_SCANCODE_D]) vx = PADDLE_SPEED; 
-        paddle.rect.x += vx * (float)delta_time; 
-        clamp_paddle_position(); 
+        g->paddle.velocity_x = 0.0f; 
+        if (ks[SDL_SCANCODE_LEFT] || ks[SDL_SCANCODE_A]) g->paddle.velocity_x = -PADDLE_SPEED; 
+        if (ks[SDL_SCANCODE_RIGHT] || ks[SDL_SCANCODE_D]) g->paddle.velocity_x = PADDLE_SPEED; 
+        if (g->paddle.velocity_x != 0.0f) input_latch.mouse_active = 0;
+        PROF_END(PROF_INPUT);
         
-        update_engine((float)delta_time); 
+        PROF_BEGIN(PROF_SIM);
+        g->fx_density = quality_tier()->particle_pct;
+        int ticks = 0;
+        while (accumulator >= tick_dt && ticks < SIM_MAX_TICKS_PER_FRAME) {
+            snap_interpolation_state(g);
+            g->paddle.rect.x += g->paddle.velocity_x * (float)tick_dt; 
+            clamp_paddle_position(g); 
+            replay_record_tick(&replay, g);
+            update_engine(g, (float)tick_dt); 
+            replay_record_result(&replay, g);
+            spectate_tick(&spec_out, g);
+            accumulator -= tick_dt;
+            ticks++;
+        }
+        if (accumulator >= tick_dt) accumulator = 0; /* fell too far behind: drop the backlog */
+        audio_submit(g);
+        PROF_END(PROF_SIM);
         
+        PROF_BEGIN(PROF_RENDER);
         SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND); 
-        render_scene(); 
+        late_latch_paddle(g);
+        render_scene(g, (float)(accumulator / tick_dt)); 
+        PROF_END(PROF_RENDER);
+        double work = (double)(SDL_GetPerformanceCounter() - now) / (double)SDL_GetPerformanceFrequency();
+        PROF_BEGIN(PROF_PRESENT);
         SDL_RenderPresent(renderer); 
-        SDL_Delay(1);
+        input_note_present();
+        PROF_END(PROF_PRESENT);
+        PROF_BEGIN(PROF_SLEEP);
+        int idle = g->game_state.show_menu || g->game_state.is_paused;
+        pacer_wait(&pacer, idle);
+        PROF_END(PROF_SLEEP);
+        quality_note_frame(frame_time, work, idle);
+#if ARK_PROFILE
+        int live_collectibles = 0;
+        for (int ci = 0; ci < MAX_COLLECTIBLES; ci++) live_collectibles += g->collectibles[ci].alive;
+        prof_frame_end(render_stats.draw_calls, render_stats.quads, g->particles.count, 
+                       live_collectibles, ticks);
+#endif
     }
-    cleanup_all();
+    pacer_report(&pacer);
+    quality_report();
+    input_report();
+    end_session(g);
     return 0;
 }